@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include "defog_kernels.h"
+
+// Compares DefogKernels::atmosphericLight with the former argsort-based Defogger::atmLight on a
+// synthetic hazy 1080p frame, and checks that both pick the same atmospheric light.
+// Usage: atm_light_bench [iterations] [width] [height]
+
+namespace {
+
+// A noisy scene under a haze that thickens towards the top, with a bright sky patch
+cv::Mat makeHazyFrame(int width, int height) {
+    cv::Mat scene(height, width, CV_8UC3);
+    cv::randu(scene, cv::Scalar::all(0), cv::Scalar::all(160));
+    cv::Mat frame;
+    scene.convertTo(frame, CV_32F, 1.0 / 255);
+    for (int r = 0; r < height; ++r) {
+        float haze = 0.8f * (1.0f - static_cast<float>(r) / height);
+        cv::Vec3f* row = frame.ptr<cv::Vec3f>(r);
+        for (int c = 0; c < width; ++c) {
+            for (int k = 0; k < 3; ++k) {
+                row[c][k] = row[c][k] * (1.0f - haze) + haze * (0.85f + 0.05f * k);
+            }
+        }
+    }
+    frame(cv::Rect(width / 3, 0, width / 4, height / 10)).setTo(cv::Scalar(0.93, 0.95, 0.97));
+    return frame;
+}
+
+// Defogger::darkChannel
+cv::Mat darkChannel(const cv::Mat& source, int size) {
+    std::vector<cv::Mat> channels;
+    cv::split(source, channels);
+    cv::Mat minChannel = (cv::min)((cv::min)(channels[0], channels[1]), channels[2]);
+    cv::Mat dark;
+    cv::erode(minChannel, dark, cv::getStructuringElement(cv::MORPH_RECT, cv::Size(size, size)));
+    return dark;
+}
+
+// The former Defogger::atmLight; stableTies breaks ties by index, which std::sort leaves unspecified
+void legacyAtmLight(const cv::Mat& source, const cv::Mat& dark, float outA[3], bool stableTies) {
+    int imgSize = source.rows * source.cols;
+    std::vector<float> darkVector = dark.reshape(1, imgSize);
+    cv::Mat srcVector = source.reshape(3, imgSize);
+
+    int numpx = int(cv::max(floor(imgSize / 1000), 1.0));
+    std::vector<int> indices(imgSize);
+    std::iota(indices.begin(), indices.end(), 0);
+    if (stableTies) {
+        std::sort(indices.begin(), indices.end(), [&darkVector](int a, int b) {
+            return darkVector[a] < darkVector[b] || (darkVector[a] == darkVector[b] && a < b);
+        });
+    } else {
+        std::sort(indices.begin(), indices.end(), [&darkVector](int a, int b) { return darkVector[a] < darkVector[b]; });
+    }
+
+    outA[0] = outA[1] = outA[2] = 0.0f;
+    for (int i = imgSize - numpx; i < imgSize; ++i) {
+        for (int k = 0; k < 3; ++k) {
+            outA[k] += srcVector.at<cv::Vec3f>(indices[i], 0)[k];
+        }
+    }
+    for (int k = 0; k < 3; ++k) {
+        outA[k] /= numpx;
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    using Clock = std::chrono::steady_clock;
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 20;
+    int width = argc > 2 ? std::atoi(argv[2]) : 1920;
+    int height = argc > 3 ? std::atoi(argv[3]) : 1080;
+
+    cv::Mat frame = makeHazyFrame(width, height);
+    cv::Mat dark = darkChannel(frame, 15);
+
+    float legacyA[3];
+    Clock::time_point begin = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        legacyAtmLight(frame, dark, legacyA, false);
+    }
+    double legacyMs = std::chrono::duration<double, std::milli>(Clock::now() - begin).count() / iterations;
+
+    float selectA[3];
+    begin = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        DefogKernels::atmosphericLight(frame, dark, selectA);
+    }
+    double selectMs = std::chrono::duration<double, std::milli>(Clock::now() - begin).count() / iterations;
+
+    float stableA[3];
+    legacyAtmLight(frame, dark, stableA, true);
+    bool identical = std::memcmp(selectA, stableA, sizeof(selectA)) == 0;
+
+    std::cout << width << "x" << height << "\n"
+              << "  argsort:        " << legacyMs << " ms/frame, A = " << legacyA[0] << ", " << legacyA[1] << ", " << legacyA[2] << "\n"
+              << "  radix select:   " << selectMs << " ms/frame, A = " << selectA[0] << ", " << selectA[1] << ", " << selectA[2] << "\n"
+              << "  Speedup:        " << legacyMs / selectMs << "x\n"
+              << "  Identical to the index-stable argsort: " << (identical ? "yes" : "NO") << std::endl;
+    return identical ? 0 : 1;
+}
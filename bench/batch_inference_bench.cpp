@@ -0,0 +1,80 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "letterbox.h"
+#include "nms.h"
+#include "opencv_detector.h"
+
+// Measures throughput and latency of the inference engine's batch path for batch sizes 1, 2, 4 and 8:
+// letterboxing into one blob, a single forward pass, then decoding and NMS of every frame.
+// Usage: batch_inference_bench <yolov3.cfg> <yolov3.weights> [iterations] [inputSize]
+
+int main(int argc, char** argv) {
+    using Clock = std::chrono::steady_clock;
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <cfg> <weights> [iterations] [inputSize]" << std::endl;
+        return 1;
+    }
+    int iterations = argc > 3 ? std::atoi(argv[3]) : 10;
+    int inputSize = argc > 4 ? std::atoi(argv[4]) : 416;
+
+    std::unique_ptr<IDetector> detector = OpenCvDetector::create(argv[1], argv[2], IDetector::Backend::OpenCV,
+                                                                 IDetector::Precision::FP32, 0.5f, inputSize);
+    if (!detector) {
+        std::cerr << "Error: Could not load the model." << std::endl;
+        return 1;
+    }
+
+    // Synthetic 720p frames; the cost of a forward pass does not depend on the content
+    std::vector<cv::Mat> frames(8);
+    for (cv::Mat& frame : frames) {
+        frame.create(720, 1280, CV_8UC3);
+        cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(255));
+    }
+
+    LetterboxPreprocessor preprocessor(inputSize);
+    NonMaxSuppressor suppressor;
+    std::vector<LetterboxTransform> transforms;
+    std::vector<Detection> candidates;
+    std::vector<int> keptIndices;
+    cv::Mat blob;
+
+    // Same steps as InferenceEngine::runInference for one batch of keyframes
+    auto runBatch = [&](int batchSize) {
+        preprocessor.allocateBlob(blob, batchSize);
+        transforms.clear();
+        for (int slot = 0; slot < batchSize; ++slot) {
+            transforms.push_back(preprocessor.apply(frames[slot], blob, slot));
+        }
+        detector->forward(blob);
+        for (int slot = 0; slot < batchSize; ++slot) {
+            candidates.clear();
+            detector->decode(static_cast<size_t>(slot), transforms[slot], candidates);
+            suppressor.run(candidates, keptIndices);
+        }
+    };
+
+    // Every frame of a batch waits for the whole pass, so the pass time is the per-frame latency
+    std::cout << "batch  frames/s  latency ms  compute/frame ms" << std::endl;
+    for (int batchSize : { 1, 2, 4, 8 }) {
+        // The first pass allocates the layer buffers for this batch size
+        runBatch(batchSize);
+
+        Clock::time_point begin = Clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            runBatch(batchSize);
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+        double batchMs = seconds * 1000.0 / iterations;
+
+        std::cout << batchSize << "      "
+                  << batchSize * iterations / seconds << "  "
+                  << batchMs << "  "
+                  << batchMs / batchSize << std::endl;
+    }
+    return 0;
+}
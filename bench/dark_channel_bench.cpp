@@ -0,0 +1,60 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include "defog_kernels.h"
+
+// Compares DefogKernels::darkChannel with the split, min and erode sequence Defogger used before, on a
+// random 1080p frame in float and 8-bit, for several window sizes, and checks both give the same dark channel.
+// Usage: dark_channel_bench [iterations] [width] [height]
+
+namespace {
+
+// The former Defogger::darkChannel
+void opencvDarkChannel(const cv::Mat& source, int size, cv::Mat& dark) {
+    std::vector<cv::Mat> channels;
+    cv::split(source, channels);
+    cv::Mat minChannel = (cv::min)((cv::min)(channels[0], channels[1]), channels[2]);
+    cv::erode(minChannel, dark, cv::getStructuringElement(cv::MORPH_RECT, cv::Size(size, size)));
+}
+
+template <typename Function>
+double timeMs(int iterations, Function function) {
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        function();
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 20;
+    int width = argc > 2 ? std::atoi(argv[2]) : 1920;
+    int height = argc > 3 ? std::atoi(argv[3]) : 1080;
+
+    cv::Mat frame8u(height, width, CV_8UC3);
+    cv::randu(frame8u, cv::Scalar::all(0), cv::Scalar::all(256));
+    cv::Mat frame32f;
+    frame8u.convertTo(frame32f, CV_32F, 1.0 / 255);
+
+    bool identical = true;
+    std::cout << width << "x" << height << std::endl;
+    for (const cv::Mat* frame : { &frame32f, &frame8u }) {
+        const char* depth = frame->depth() == CV_32F ? "float" : "8-bit";
+        for (int size : { 3, 15, 31, 61 }) {
+            cv::Mat expected, dark;
+            double opencvMs = timeMs(iterations, [&] { opencvDarkChannel(*frame, size, expected); });
+            double kernelMs = timeMs(iterations, [&] { DefogKernels::darkChannel(*frame, size, dark); });
+            bool same = cv::norm(expected, dark, cv::NORM_INF) == 0.0;
+            identical = identical && same;
+            std::cout << "  " << depth << ", window " << size << ": split/min/erode " << opencvMs
+                      << " ms, fused " << kernelMs << " ms, speedup " << opencvMs / kernelMs << "x"
+                      << (same ? "" : ", RESULTS DIFFER") << std::endl;
+        }
+    }
+    return identical ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/videoio.hpp>
+#include "defogger.h"
+
+// Runs the float and the 8-bit fixed-point paths of the Defogger on the same frames, reports the throughput
+// of each and the PSNR of the fixed-point output taken against the float one.
+// Usage: defog_precision_bench [frames] [videoPath]; without a video, a synthetic hazy 1080p frame is used.
+
+namespace {
+
+// A noisy scene under a haze that thickens towards the top
+cv::Mat makeHazyFrame(int width, int height) {
+    cv::Mat scene(height, width, CV_8UC3);
+    cv::randu(scene, cv::Scalar::all(0), cv::Scalar::all(160));
+    cv::GaussianBlur(scene, scene, cv::Size(5, 5), 0);
+    cv::Mat frame(height, width, CV_8UC3);
+    for (int r = 0; r < height; ++r) {
+        float haze = 0.8f * (1.0f - static_cast<float>(r) / height);
+        const cv::Vec3b* sceneRow = scene.ptr<cv::Vec3b>(r);
+        cv::Vec3b* row = frame.ptr<cv::Vec3b>(r);
+        for (int c = 0; c < width; ++c) {
+            for (int k = 0; k < 3; ++k) {
+                row[c][k] = cv::saturate_cast<uchar>(sceneRow[c][k] * (1.0f - haze) + haze * (215.0f + 10.0f * k));
+            }
+        }
+    }
+    return frame;
+}
+
+double defogAll(Defogger& defogger, const std::vector<cv::Mat>& frames, std::vector<cv::Mat>& outputs) {
+    outputs.resize(frames.size());
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < frames.size(); ++i) {
+        defogger.defog(frames[i], outputs[i]);
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t frameCount = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 20;
+    std::vector<cv::Mat> frames;
+    if (argc > 2) {
+        cv::VideoCapture capture(argv[2]);
+        cv::Mat frame;
+        while (frames.size() < frameCount && capture.read(frame)) {
+            frames.push_back(frame.clone());
+        }
+    } else {
+        cv::Mat frame = makeHazyFrame(1920, 1080);
+        frames.assign(frameCount, frame);
+    }
+    if (frames.empty()) {
+        std::cerr << "No frames to defog." << std::endl;
+        return 1;
+    }
+
+    EventDispatcher dispatcher;
+    Defogger defogger(dispatcher);
+    std::vector<cv::Mat> floatOutputs;
+    std::vector<cv::Mat> fixedOutputs;
+    double floatMs = defogAll(defogger, frames, floatOutputs);
+    defogger.setFixedPoint(true);
+    double fixedMs = defogAll(defogger, frames, fixedOutputs);
+
+    double psnrSum = 0.0;
+    double psnrMin = 1e9;
+    for (size_t i = 0; i < frames.size(); ++i) {
+        double psnr = cv::PSNR(floatOutputs[i], fixedOutputs[i]);
+        psnrSum += psnr;
+        psnrMin = std::min(psnrMin, psnr);
+    }
+
+    std::cout << frames.size() << " frames of " << frames[0].cols << "x" << frames[0].rows << "\n"
+              << "  float:       " << floatMs / frames.size() << " ms/frame, " << 1000.0 * frames.size() / floatMs << " fps\n"
+              << "  fixed-point: " << fixedMs / frames.size() << " ms/frame, " << 1000.0 * frames.size() / fixedMs << " fps\n"
+              << "  Speedup:     " << floatMs / fixedMs << "x\n"
+              << "  PSNR of the fixed-point output against the float one: mean " << psnrSum / frames.size()
+              << " dB, min " << psnrMin << " dB" << std::endl;
+    return 0;
+}
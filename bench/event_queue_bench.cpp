@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "event_dispatcher.h"
+
+// Compares the mutex queue and the lock-free ring behind EventDispatcher::postEvent.
+// Usage: event_queue_bench [producers] [eventsPerProducer]
+
+namespace {
+
+struct BenchResult {
+    double eventsPerSecond;
+    double p50EnqueueNs;
+    double p99EnqueueNs;
+};
+
+BenchResult runBench(EventDispatcher::QueueBackend backend, int producers, int eventsPerProducer) {
+    using Clock = std::chrono::steady_clock;
+    const long long totalEvents = static_cast<long long>(producers) * eventsPerProducer;
+
+    EventDispatcher dispatcher(backend, 4096);
+    std::atomic<long long> consumed(0);
+    dispatcher.registerHandler(Event::Type::FrameCaptureReady, [&](const Event&) {
+        consumed.fetch_add(1, std::memory_order_relaxed);
+    });
+
+    std::thread loopThread(&EventDispatcher::startEventloop, &dispatcher);
+
+    std::atomic<bool> go(false);
+    std::vector<std::vector<long long>> latencies(producers);
+    std::vector<std::thread> producerThreads;
+    for (int p = 0; p < producers; ++p) {
+        producerThreads.emplace_back([&, p]() {
+            std::vector<long long>& samples = latencies[p];
+            samples.reserve(eventsPerProducer);
+            while (!go.load()) {
+                std::this_thread::yield();
+            }
+            for (int i = 0; i < eventsPerProducer; ++i) {
+                Clock::time_point begin = Clock::now();
+                dispatcher.postEvent(Event(Event::Type::FrameCaptureReady, std::make_pair(cv::Mat(), cv::Mat())));
+                samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count());
+            }
+        });
+    }
+
+    Clock::time_point start = Clock::now();
+    go.store(true);
+    for (std::thread& thread : producerThreads) {
+        thread.join();
+    }
+    while (consumed.load(std::memory_order_relaxed) < totalEvents) {
+        std::this_thread::yield();
+    }
+    Clock::time_point lastConsumed = Clock::now();
+    dispatcher.shutdownEventloop();
+    loopThread.join();
+
+    std::vector<long long> all;
+    all.reserve(totalEvents);
+    for (const std::vector<long long>& samples : latencies) {
+        all.insert(all.end(), samples.begin(), samples.end());
+    }
+    std::sort(all.begin(), all.end());
+
+    BenchResult result;
+    result.eventsPerSecond = totalEvents / std::chrono::duration<double>(lastConsumed - start).count();
+    result.p50EnqueueNs = static_cast<double>(all[all.size() / 2]);
+    result.p99EnqueueNs = static_cast<double>(all[std::min(all.size() - 1, all.size() * 99 / 100)]);
+    return result;
+}
+
+void printResult(const std::string& name, const BenchResult& result) {
+    std::cout << name
+              << "  events/sec: " << static_cast<long long>(result.eventsPerSecond)
+              << "  p50 enqueue: " << result.p50EnqueueNs << " ns"
+              << "  p99 enqueue: " << result.p99EnqueueNs << " ns" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int producers = argc > 1 ? std::atoi(argv[1]) : 3;
+    int eventsPerProducer = argc > 2 ? std::atoi(argv[2]) : 200000;
+    if (producers < 1 || eventsPerProducer < 1) {
+        std::cerr << "Usage: " << argv[0] << " [producers] [eventsPerProducer]" << std::endl;
+        return 1;
+    }
+
+    // Each ring slot holds a whole Event, detections included
+    std::cout << "Event: " << sizeof(Event) << " bytes, ring of 4096 slots: "
+              << sizeof(Event) * 4096 / 1024 << " KiB per lane" << std::endl;
+    std::cout << producers << " producers x " << eventsPerProducer << " events" << std::endl;
+    printResult("mutex queue   ", runBench(EventDispatcher::QueueBackend::Mutex, producers, eventsPerProducer));
+    printResult("lock-free ring", runBench(EventDispatcher::QueueBackend::LockFreeRing, producers, eventsPerProducer));
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include "defog_kernels.h"
+
+// Compares the fast, subsampled guided filter with the full-resolution one on the transmission refinement of a
+// synthetic hazy 1080p frame, with the window and eps of Defogger::transmissionRefine.
+// Usage: guided_filter_bench [iterations] [width] [height]
+
+namespace {
+
+// A grey guide with edges and texture, and a blocky transmission estimate like the one of the dark channel
+void makeInputs(int width, int height, cv::Mat& guide, cv::Mat& transmission) {
+    cv::Mat scene(height, width, CV_8UC3);
+    cv::randu(scene, cv::Scalar::all(0), cv::Scalar::all(160));
+    cv::GaussianBlur(scene, scene, cv::Size(9, 9), 0);
+    for (int i = 0; i < 12; ++i) {
+        cv::Rect box(width * i / 12, height * (i % 4) / 5, width / 10, height / 4);
+        scene(box).setTo(cv::Scalar::all(40 + 15 * i));
+    }
+    cv::Mat hazy(height, width, CV_32FC3);
+    for (int r = 0; r < height; ++r) {
+        float haze = 0.8f * (1.0f - static_cast<float>(r) / height);
+        const cv::Vec3b* sceneRow = scene.ptr<cv::Vec3b>(r);
+        cv::Vec3f* row = hazy.ptr<cv::Vec3f>(r);
+        for (int c = 0; c < width; ++c) {
+            for (int k = 0; k < 3; ++k) {
+                row[c][k] = sceneRow[c][k] / 255.0f * (1.0f - haze) + haze * 0.9f;
+            }
+        }
+    }
+
+    cv::Mat gray;
+    cv::cvtColor(hazy, gray, cv::COLOR_BGR2GRAY);
+    guide = gray;
+    const float atmosphericLight[3] = { 0.9f, 0.9f, 0.9f };
+    cv::Mat dark;
+    DefogKernels::darkChannel(hazy, 15, dark, atmosphericLight);
+    transmission = 1 - 0.95 * dark;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 10;
+    int width = argc > 2 ? std::atoi(argv[2]) : 1920;
+    int height = argc > 3 ? std::atoi(argv[3]) : 1080;
+    const int windowSize = 60;
+    const float eps = 0.0001f;
+
+    cv::Mat guide, transmission;
+    makeInputs(width, height, guide, transmission);
+
+    cv::Mat reference;
+    double referenceMs = 0.0;
+    std::cout << width << "x" << height << ", window " << windowSize << std::endl;
+    for (int subsample : { 1, 2, 4, 8 }) {
+        cv::Mat refined;
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            DefogKernels::guidedFilter(guide, transmission, windowSize, eps, subsample, refined);
+        }
+        double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count() / iterations;
+        if (subsample == 1) {
+            reference = refined;
+            referenceMs = elapsedMs;
+            std::cout << "  full resolution: " << elapsedMs << " ms" << std::endl;
+            continue;
+        }
+        // The transmission lies in [0, 1], so the PSNR is taken with a peak of 1
+        std::cout << "  subsample " << subsample << ": " << elapsedMs << " ms, speedup " << referenceMs / elapsedMs
+                  << "x, max error " << cv::norm(reference, refined, cv::NORM_INF)
+                  << ", PSNR " << cv::PSNR(reference, refined, 1.0) << " dB" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <opencv2/dnn.hpp>
+#include "nms.h"
+
+// Compares NonMaxSuppressor with cv::dnn::NMSBoxes on dense synthetic scenes.
+// Usage: nms_bench [objects] [boxesPerObject] [classes] [iterations]
+
+namespace {
+
+std::vector<Detection> makeScene(int objects, int boxesPerObject, int classes, std::mt19937& rng) {
+    std::uniform_real_distribution<float> position(0.0f, 1800.0f);
+    std::uniform_real_distribution<float> size(20.0f, 300.0f);
+    std::normal_distribution<float> jitter(0.0f, 6.0f);
+    std::uniform_real_distribution<float> score(0.3f, 1.0f);
+    std::uniform_int_distribution<int> classId(0, classes - 1);
+
+    // Every object yields a cluster of overlapping proposals, as YOLO does across anchors and scales
+    std::vector<Detection> candidates;
+    candidates.reserve(static_cast<size_t>(objects) * boxesPerObject);
+    for (int o = 0; o < objects; ++o) {
+        cv::Rect2f object(position(rng), position(rng), size(rng), size(rng));
+        int objectClass = classId(rng);
+        for (int b = 0; b < boxesPerObject; ++b) {
+            cv::Rect2f box(object.x + jitter(rng), object.y + jitter(rng),
+                           std::max(1.0f, object.width + jitter(rng)), std::max(1.0f, object.height + jitter(rng)));
+            candidates.push_back({ box, score(rng), objectClass });
+        }
+    }
+    return candidates;
+}
+
+// Class-aware NMSBoxes: boxes of different classes are moved apart so they never overlap
+void runOpenCv(const std::vector<Detection>& candidates, float iouThreshold, std::vector<cv::Rect2d>& boxes,
+               std::vector<float>& scores, std::vector<int>& kept) {
+    const double classOffset = 4096.0;
+    boxes.clear();
+    scores.clear();
+    for (const Detection& candidate : candidates) {
+        double offset = candidate.classId * classOffset;
+        boxes.emplace_back(candidate.box.x + offset, candidate.box.y + offset, candidate.box.width, candidate.box.height);
+        scores.push_back(candidate.score);
+    }
+    cv::dnn::NMSBoxes(boxes, scores, 0.0f, iouThreshold, kept);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    using Clock = std::chrono::steady_clock;
+    int objects = argc > 1 ? std::atoi(argv[1]) : 200;
+    int boxesPerObject = argc > 2 ? std::atoi(argv[2]) : 30;
+    int classes = argc > 3 ? std::atoi(argv[3]) : 80;
+    int iterations = argc > 4 ? std::atoi(argv[4]) : 50;
+    const float iouThreshold = 0.45f;
+
+    std::mt19937 rng(42);
+    std::vector<Detection> candidates = makeScene(objects, boxesPerObject, classes, rng);
+
+    NonMaxSuppressor suppressor(iouThreshold);
+    std::vector<int> keptOwn;
+    std::vector<cv::Rect2d> boxes;
+    std::vector<float> scores;
+    std::vector<int> keptOpenCv;
+
+    // Warm up the scratch buffers of both implementations
+    suppressor.run(candidates, keptOwn);
+    runOpenCv(candidates, iouThreshold, boxes, scores, keptOpenCv);
+
+    Clock::time_point begin = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        suppressor.run(candidates, keptOwn);
+    }
+    double ownUs = std::chrono::duration<double, std::micro>(Clock::now() - begin).count() / iterations;
+
+    begin = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        runOpenCv(candidates, iouThreshold, boxes, scores, keptOpenCv);
+    }
+    double openCvUs = std::chrono::duration<double, std::micro>(Clock::now() - begin).count() / iterations;
+
+    std::sort(keptOwn.begin(), keptOwn.end());
+    std::sort(keptOpenCv.begin(), keptOpenCv.end());
+    std::vector<int> difference;
+    std::set_symmetric_difference(keptOwn.begin(), keptOwn.end(), keptOpenCv.begin(), keptOpenCv.end(),
+                                  std::back_inserter(difference));
+
+    std::cout << candidates.size() << " candidates, " << classes << " classes, IoU " << iouThreshold << "\n"
+              << "NonMaxSuppressor:    " << ownUs << " us/frame, kept " << keptOwn.size() << "\n"
+              << "cv::dnn::NMSBoxes:   " << openCvUs << " us/frame, kept " << keptOpenCv.size() << "\n"
+              << "Speedup:             " << openCvUs / ownUs << "x, differing boxes " << difference.size() << std::endl;
+    return 0;
+}
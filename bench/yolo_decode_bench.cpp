@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <opencv2/core.hpp>
+#include "yolo_decoder.h"
+
+// Compares YoloDecoder with the former per-row Mat::at + std::max_element loop on synthetic
+// YOLOv3 outputs for 416x416 and 608x608 inputs.
+// Usage: yolo_decode_bench [iterations] [confidenceThreshold]
+
+namespace {
+
+// Rows of the three YOLOv3 output layers for a square input: 3 anchors on strides 32, 16 and 8
+int yoloRows(int inputSize) {
+    int rows = 0;
+    for (int stride : { 32, 16, 8 }) {
+        int cells = inputSize / stride;
+        rows += 3 * cells * cells;
+    }
+    return rows;
+}
+
+// Most rows have a tiny objectness, as in real frames; class scores are scaled by it like the region layer does
+cv::Mat makeOutput(int rows, std::mt19937& rng) {
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    cv::Mat output(rows, 85, CV_32F);
+    for (int i = 0; i < rows; ++i) {
+        float* row = output.ptr<float>(i);
+        for (int k = 0; k < 4; ++k) {
+            row[k] = unit(rng);
+        }
+        float objectness = unit(rng) < 0.01f ? unit(rng) : unit(rng) * 0.01f;
+        row[4] = objectness;
+        for (int c = 5; c < 85; ++c) {
+            row[c] = objectness * unit(rng);
+        }
+    }
+    return output;
+}
+
+void legacyDecode(cv::Mat& detection, const cv::Size& frameSize, float confidenceThreshold, std::vector<Detection>& candidates) {
+    for (int i = 0; i < detection.rows; ++i) {
+        const int probability_index = 5;
+        const int probability_size = detection.cols - probability_index;
+        float* prob_array_ptr = &detection.at<float>(i, probability_index);
+        size_t objectClass = std::max_element(prob_array_ptr, prob_array_ptr + probability_size) - prob_array_ptr;
+        float confidence = detection.at<float>(i, (int)objectClass + probability_index);
+
+        if (confidence > confidenceThreshold) {
+            float x_center = detection.at<float>(i, 0) * frameSize.width;
+            float y_center = detection.at<float>(i, 1) * frameSize.height;
+            float width = detection.at<float>(i, 2) * frameSize.width;
+            float height = detection.at<float>(i, 3) * frameSize.height;
+            candidates.push_back({ cv::Rect2f(x_center - width / 2, y_center - height / 2, width, height), confidence, (int)objectClass });
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    using Clock = std::chrono::steady_clock;
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 200;
+    float confidenceThreshold = argc > 2 ? static_cast<float>(std::atof(argv[2])) : 0.3f;
+    const cv::Size frameSize(1280, 720);
+
+    std::mt19937 rng(7);
+    YoloDecoder decoder(confidenceThreshold);
+    std::vector<Detection> candidates;
+    candidates.reserve(1024);
+
+    for (int inputSize : { 416, 608 }) {
+        cv::Mat output = makeOutput(yoloRows(inputSize), rng);
+
+        Clock::time_point begin = Clock::now();
+        size_t legacyCount = 0;
+        for (int i = 0; i < iterations; ++i) {
+            candidates.clear();
+            legacyDecode(output, frameSize, confidenceThreshold, candidates);
+            legacyCount = candidates.size();
+        }
+        double legacyUs = std::chrono::duration<double, std::micro>(Clock::now() - begin).count() / iterations;
+
+        begin = Clock::now();
+        size_t decoderCount = 0;
+        for (int i = 0; i < iterations; ++i) {
+            candidates.clear();
+            decoder.decode(output, LetterboxTransform::stretch(frameSize), candidates);
+            decoderCount = candidates.size();
+        }
+        double decoderUs = std::chrono::duration<double, std::micro>(Clock::now() - begin).count() / iterations;
+
+        std::cout << inputSize << "x" << inputSize << ": " << output.rows << " rows\n"
+                  << "  at + max_element: " << legacyUs << " us/frame, " << legacyCount << " candidates\n"
+                  << "  YoloDecoder:      " << decoderUs << " us/frame, " << decoderCount << " candidates\n"
+                  << "  Speedup:          " << legacyUs / decoderUs << "x" << std::endl;
+    }
+    return 0;
+}
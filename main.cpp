@@ -2,9 +2,40 @@
 #include <string>
 #include "video_processor.h"
 #include "inference_engine.h"
+#include "detection_renderer.h"
+#include "model_registry.h"
+#include "opencv_detector.h"
+#include "detector_evaluator.h"
 #include "gui_renderer.h"
+#include "headless_sink.h"
 #include "defogger.h"
 #include "commandline_args.h"
+#include "frame_pool.h"
+#include "metrics_registry.h"
+#include "metrics_reporter.h"
+#include "shutdown_signal.h"
+
+// Runs the clip through the FP32 model and through the evaluated precision or model, and prints the comparison
+int runEvaluation(const CommandLineArgs& cmdArgs, const std::string& cfgPath, const std::string& weightsPath) {
+    const bool otherModel = !cmdArgs.getEvaluateModelPath().empty();
+    std::unique_ptr<IDetector> reference = OpenCvDetector::create(
+        cfgPath, weightsPath, IDetector::Backend::OpenCV, IDetector::Precision::FP32,
+        static_cast<float>(cmdArgs.getConfidenceThreshold()), cmdArgs.getInputSize());
+    std::unique_ptr<IDetector> candidate = OpenCvDetector::create(
+        otherModel ? std::string() : cfgPath, otherModel ? cmdArgs.getEvaluateModelPath() : weightsPath,
+        cmdArgs.getBackend(), cmdArgs.getPrecision(),
+        static_cast<float>(cmdArgs.getConfidenceThreshold()), cmdArgs.getInputSize());
+    if (!reference || !candidate) {
+        std::cerr << "Error: Could not load the model." << std::endl;
+        return 1;
+    }
+    ModelRegistry::instance().releaseCopies();
+
+    DetectorEvaluator evaluator(static_cast<float>(cmdArgs.getNmsThreshold()), cmdArgs.getInputSize());
+    DetectorEvaluator::Result result = evaluator.run(cmdArgs.getVideoPath(), *reference, *candidate, cmdArgs.getMaxFrames());
+    DetectorEvaluator::print(result, std::cout);
+    return result.frames > 0 ? 0 : 1;
+}
 
 int main(int argc, char** argv) {
 
@@ -17,56 +48,214 @@ int main(int argc, char** argv) {
         return 1;
     }
 
+    // The Darknet YOLOv3 of the model directory, or an ONNX model, which has no separate configuration file
+    const bool onnxModel = !cmdArgs.getOnnxModelPath().empty();
+    const std::string cfgPath = onnxModel ? std::string() : cmdArgs.getModelPath() + "/yolov3.cfg";
+    const std::string weightsPath = onnxModel ? cmdArgs.getOnnxModelPath() : cmdArgs.getModelPath() + "/yolov3.weights";
+
+    // Map the model files instead of copying them, so processes running the same model share their pages
+    ModelRegistry::instance().setMemoryMapping(cmdArgs.isModelMemoryMapped());
+
+    // Compare detectors on the clip instead of running the pipeline
+    if (cmdArgs.isEvaluation()) {
+        return runEvaluation(cmdArgs, cfgPath, weightsPath);
+    }
+
     // Create an EventDispatcher to manage event handling
-    EventDispatcher dispatcher;
+    EventDispatcher dispatcher(cmdArgs.getEventQueueBackend(), 1024, cmdArgs.getDispatchThreads());
 
     // Initialize the VideoProcessor with the path to the video file and the dispatcher
     VideoProcessor videoProcessor(cmdArgs.getVideoPath(), dispatcher);
+    videoProcessor.setRealtime(cmdArgs.isRealtime());
 
     // Initialize the Defogger with the dispatcher
     Defogger defogger(dispatcher);
 
-    // Initialize the InferenceEngine with paths to model configuration, weights, class names, colors, and the confidence threshold
+    // Initialize the InferenceEngine with paths to model configuration, weights, and the confidence and NMS thresholds
     InferenceEngine inferenceEngine(
-        cmdArgs.getModelPath() + "/yolov3.cfg",
-        cmdArgs.getModelPath() + "/yolov3.weights",
-        cmdArgs.getModelPath() + "/coco_classes.txt",
-        cmdArgs.getModelPath() + "/coco_colors.txt",
+        cfgPath,
+        weightsPath,
         cmdArgs.getConfidenceThreshold(),
+        cmdArgs.getNmsThreshold(),
         dispatcher
         );
 
-    // Initialize the GUIRenderer with the dispatcher
-    GUIRenderer guiRenderer(dispatcher);
+    // Initialize the DetectionRenderer with class names and colors, unless drawing is disabled
+    std::unique_ptr<DetectionRenderer> detectionRenderer;
+    if (cmdArgs.isDrawingEnabled()) {
+        detectionRenderer = std::make_unique<DetectionRenderer>(
+            cmdArgs.getModelPath() + "/coco_classes.txt",
+            cmdArgs.getModelPath() + "/coco_colors.txt",
+            dispatcher,
+            cmdArgs.isModelMemoryMapped());
+    }
+
+    // Initialize the last stage: the GUIRenderer, or a sink when running without a display
+    std::unique_ptr<IProcessor> outputStage;
+    std::string outputStageName;
+    if (cmdArgs.isHeadless()) {
+        outputStage = std::make_unique<HeadlessSink>(dispatcher, cmdArgs.getOutputPath(), cmdArgs.getMaxFrames());
+        outputStageName = "sink";
+    } else {
+        outputStage = std::make_unique<GUIRenderer>(dispatcher);
+        outputStageName = "gui";
+    }
+
+    // Run the CPU-bound stages on several workers; their output is reordered before the next stage
+    defogger.setWorkerCount(cmdArgs.getDefogWorkers());
+    inferenceEngine.setWorkerCount(cmdArgs.getInferenceWorkers());
+
+    // Defog 8-bit frames in fixed point instead of float if asked, and refine the transmission on a smaller frame
+    defogger.setFixedPoint(cmdArgs.isDefogFixedPoint());
+    defogger.setGuidedSubsample(cmdArgs.getGuidedSubsample());
+
+    // Reuse the atmospheric light and the transmission map across frames, refreshing them on scene changes
+    defogger.setTemporal(cmdArgs.isDefogTemporal(), cmdArgs.getLightInterval(), cmdArgs.getLightSmoothing(),
+                         cmdArgs.getTransmissionInterval(), cmdArgs.getTransmissionScale());
+
+    // Run up to batchSize frames through the network per forward pass
+    inferenceEngine.setBatching(cmdArgs.getBatchSize(), std::chrono::milliseconds(cmdArgs.getBatchTimeoutMs()));
+    inferenceEngine.setInputSize(cmdArgs.getInputSize());
+
+    // Pick the fastest backend and precision this host and OpenCV build offer
+    inferenceEngine.setBackend(cmdArgs.getBackend(), cmdArgs.getPrecision());
+
+    // Run the network on every n-th frame only and track the boxes in between
+    inferenceEngine.setDetectionStride(cmdArgs.getDetectionStride(), cmdArgs.isAdaptiveStride());
+
+    // Skip the network on frames where nothing moved
+    inferenceEngine.setMotionGate(cmdArgs.isMotionGateEnabled(), cmdArgs.getMotionThreshold());
+
+    // Bound the queue in front of every consuming stage. Under the block policy each producer reserves a
+    // slot of the next stage before posting, so the wait happens on the producing thread
+    defogger.setQueueLimit(cmdArgs.getQueueCapacity(), cmdArgs.getQueuePolicy());
+    inferenceEngine.setQueueLimit(cmdArgs.getQueueCapacity(), cmdArgs.getQueuePolicy());
+    if (detectionRenderer) {
+        detectionRenderer->setQueueLimit(cmdArgs.getQueueCapacity(), cmdArgs.getQueuePolicy());
+    }
+    outputStage->setQueueLimit(cmdArgs.getQueueCapacity(), cmdArgs.getQueuePolicy());
+    videoProcessor.setDownstream(&defogger);
+    defogger.setDownstream(&inferenceEngine);
+    if (detectionRenderer) {
+        inferenceEngine.setDownstream(detectionRenderer.get());
+        detectionRenderer->setDownstream(outputStage.get());
+    } else {
+        inferenceEngine.setDownstream(outputStage.get());
+    }
 
     // Register event handlers for various event types
+    // Handlers take the event as an rvalue so frames are moved into the processors
     dispatcher.registerHandler(
         Event::Type::FrameCaptureReady,
-        std::bind(&Defogger::handleEvent, &defogger, std::placeholders::_1)
+        [&defogger](Event&& event) { defogger.handleEvent(std::move(event)); }
         );
     dispatcher.registerHandler(
         Event::Type::FrameDefoggerReady,
-        std::bind(&InferenceEngine::handleEvent, &inferenceEngine, std::placeholders::_1)
+        [&inferenceEngine](Event&& event) { inferenceEngine.handleEvent(std::move(event)); }
         );
+    if (detectionRenderer) {
+        dispatcher.registerHandler(
+            Event::Type::DetectionResultsReady,
+            [&detectionRenderer](Event&& event) { detectionRenderer->handleEvent(std::move(event)); }
+            );
+    } else {
+        // Without drawing, the detected frames go straight to the last stage
+        dispatcher.registerHandler(
+            Event::Type::DetectionResultsReady,
+            [&outputStage](Event&& event) {
+                event.type = Event::Type::FrameDetectionReady;
+                outputStage->handleEvent(std::move(event));
+            }
+            );
+    }
     dispatcher.registerHandler(
         Event::Type::FrameDetectionReady,
-        std::bind(&GUIRenderer::handleEvent, &guiRenderer, std::placeholders::_1)
+        [&outputStage](Event&& event) { outputStage->handleEvent(std::move(event)); }
         );
 
+    // Export the counters kept outside the stages alongside the stage metrics
+    MetricsRegistry& metrics = MetricsRegistry::instance();
+    metrics.registerGauge("frame_pool_hit_ratio", "Fraction of frame buffer allocations served by the frame pool.",
+                          []() { return FramePool::instance().stats().hitRate(); });
+    metrics.registerGauge("frame_pool_resident_bytes", "Bytes of frame buffers owned by the frame pool.",
+                          []() { return static_cast<double>(FramePool::instance().stats().residentBytes); });
+    metrics.registerGauge("process_resident_bytes", "Resident set size of the process, one copy of the weights per inference worker included.",
+                          []() { return static_cast<double>(MetricsRegistry::residentSetBytes()); });
+    metrics.registerGauge("inference_tracked_frames", "Frames whose boxes were tracked instead of detected.",
+                          [&inferenceEngine]() { return static_cast<double>(inferenceEngine.trackedFrames()); });
+    metrics.registerGauge("inference_motion_skipped_frames", "Frames skipped by the motion gate.",
+                          [&inferenceEngine]() { return static_cast<double>(inferenceEngine.motionSkippedFrames()); });
+    metrics.registerGauge("defogger_light_estimates", "Frames the atmospheric light was estimated on.",
+                          [&defogger]() { return static_cast<double>(defogger.lightEstimates()); });
+    metrics.registerGauge("defogger_transmission_estimates", "Frames a transmission map was computed for.",
+                          [&defogger]() { return static_cast<double>(defogger.transmissionEstimates()); });
+    metrics.registerGauge("event_payload_copies", "Events copied instead of moved since start.",
+                          []() { return static_cast<double>(Event::payloadCopyCount()); });
+
+    std::unique_ptr<MetricsReporter> metricsReporter;
+    if (!cmdArgs.getMetricsTarget().empty()) {
+        metricsReporter = std::make_unique<MetricsReporter>(
+            metrics, cmdArgs.getMetricsFormat(), cmdArgs.getMetricsTarget(),
+            std::chrono::milliseconds(static_cast<int64_t>(cmdArgs.getMetricsInterval() * 1000.0)));
+        metricsReporter->start();
+    }
+
     // Start processing in all components
-    guiRenderer.start();
+    outputStage->start();
+    if (detectionRenderer) {
+        detectionRenderer->start();
+    }
+    // Every inference worker has its network once start() returns
+    std::chrono::steady_clock::time_point modelStart = std::chrono::steady_clock::now();
     inferenceEngine.start();
+    double modelReadyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - modelStart).count();
+    // The nets are built; drop the heap copy of the weights so only the nets stay resident
+    ModelRegistry::instance().releaseCopies();
+    ModelRegistry::Stats modelStats = ModelRegistry::instance().stats();
+    std::cout << "Model ready in " << modelReadyMs << " ms (files " << modelStats.fileLoadMs << " ms, "
+              << (modelStats.mappedBytes > 0 ? "mapped, " : "read, ")
+              << modelStats.netsCreated << " nets with their own weights " << modelStats.netBuildMs << " ms), RSS "
+              << MetricsRegistry::residentSetBytes() / (1024 * 1024) << " MiB" << std::endl;
     defogger.start();
     videoProcessor.start();
 
-    // Start the event loop to process events
-    dispatcher.startEventloop();
+    // Start the event loop to process events. It ends when the window is closed, the headless
+    // frame limit is reached, or on SIGINT/SIGTERM.
+    {
+        ShutdownSignal shutdownSignal([&dispatcher]() { dispatcher.shutdownEventloop(); });
+        dispatcher.startEventloop();
+    }
 
     // Stop all components after the event loop ends
     videoProcessor.stop();
     defogger.stop();
     inferenceEngine.stop();
-    guiRenderer.stop();
+    if (detectionRenderer) {
+        detectionRenderer->stop();
+    }
+    outputStage->stop();
+    if (metricsReporter) {
+        metricsReporter->stop();
+    }
+
+    std::cout << "Event payload copies: " << Event::payloadCopyCount() << std::endl;
+    std::cout << "Dropped frames: defogger " << defogger.droppedFrames()
+              << ", inference " << inferenceEngine.droppedFrames()
+              << ", renderer " << (detectionRenderer ? detectionRenderer->droppedFrames() : 0)
+              << ", " << outputStageName << " " << outputStage->droppedFrames() << std::endl;
+    std::cout << "Tracked frames: " << inferenceEngine.trackedFrames()
+              << ", motion skipped frames: " << inferenceEngine.motionSkippedFrames() << std::endl;
+    std::cout << "Defogger estimates: atmospheric light " << defogger.lightEstimates()
+              << ", transmission " << defogger.transmissionEstimates() << std::endl;
+
+    if (HeadlessSink* sink = dynamic_cast<HeadlessSink*>(outputStage.get())) {
+        std::cout << "Sink: " << sink->frameCount() << " frames, " << sink->averageFps() << " fps" << std::endl;
+    }
+
+    FramePool::Stats poolStats = FramePool::instance().stats();
+    std::cout << "Frame pool: hit rate " << poolStats.hitRate() * 100.0 << "%, resident "
+              << poolStats.residentBytes / (1024 * 1024) << " MiB, cached "
+              << poolStats.cachedBytes / (1024 * 1024) << " MiB" << std::endl;
 
     return 0;
 }
@@ -16,12 +16,170 @@ double CommandLineArgs::getConfidenceThreshold() const {
     return confidenceThreshold;
 }
 
+double CommandLineArgs::getNmsThreshold() const {
+    return nmsThreshold;
+}
+
+EventDispatcher::QueueBackend CommandLineArgs::getEventQueueBackend() const {
+    return eventQueueBackend;
+}
+
+int CommandLineArgs::getDispatchThreads() const {
+    return dispatchThreads;
+}
+
+size_t CommandLineArgs::getQueueCapacity() const {
+    return queueCapacity;
+}
+
+IProcessor::OverflowPolicy CommandLineArgs::getQueuePolicy() const {
+    return queuePolicy;
+}
+
+int CommandLineArgs::getDefogWorkers() const {
+    return defogWorkers;
+}
+
+bool CommandLineArgs::isDefogFixedPoint() const {
+    return defogFixedPoint;
+}
+
+int CommandLineArgs::getGuidedSubsample() const {
+    return guidedSubsample;
+}
+
+bool CommandLineArgs::isDefogTemporal() const {
+    return defogTemporal;
+}
+
+int CommandLineArgs::getLightInterval() const {
+    return lightInterval;
+}
+
+double CommandLineArgs::getLightSmoothing() const {
+    return lightSmoothing;
+}
+
+int CommandLineArgs::getTransmissionInterval() const {
+    return transmissionInterval;
+}
+
+int CommandLineArgs::getTransmissionScale() const {
+    return transmissionScale;
+}
+
+int CommandLineArgs::getInferenceWorkers() const {
+    return inferenceWorkers;
+}
+
+int CommandLineArgs::getBatchSize() const {
+    return batchSize;
+}
+
+int CommandLineArgs::getBatchTimeoutMs() const {
+    return batchTimeoutMs;
+}
+
+int CommandLineArgs::getInputSize() const {
+    return inputSize;
+}
+
+bool CommandLineArgs::isModelMemoryMapped() const {
+    return modelMemoryMapped;
+}
+
+std::string CommandLineArgs::getOnnxModelPath() const {
+    return onnxModelPath;
+}
+
+IDetector::Backend CommandLineArgs::getBackend() const {
+    return backend;
+}
+
+IDetector::Precision CommandLineArgs::getPrecision() const {
+    return precision;
+}
+
+bool CommandLineArgs::isEvaluation() const {
+    return evaluation;
+}
+
+std::string CommandLineArgs::getEvaluateModelPath() const {
+    return evaluateModelPath;
+}
+
+int CommandLineArgs::getDetectionStride() const {
+    return detectionStride;
+}
+
+bool CommandLineArgs::isAdaptiveStride() const {
+    return adaptiveStride;
+}
+
+bool CommandLineArgs::isMotionGateEnabled() const {
+    return motionGateEnabled;
+}
+
+double CommandLineArgs::getMotionThreshold() const {
+    return motionThreshold;
+}
+
+std::string CommandLineArgs::getMetricsTarget() const {
+    return metricsTarget;
+}
+
+MetricsReporter::Format CommandLineArgs::getMetricsFormat() const {
+    return metricsFormat;
+}
+
+double CommandLineArgs::getMetricsInterval() const {
+    return metricsInterval;
+}
+
+bool CommandLineArgs::isHeadless() const {
+    return headless;
+}
+
+std::string CommandLineArgs::getOutputPath() const {
+    return outputPath;
+}
+
+uint64_t CommandLineArgs::getMaxFrames() const {
+    return maxFrames;
+}
+
+bool CommandLineArgs::isRealtime() const {
+    return realtime;
+}
+
+bool CommandLineArgs::isDrawingEnabled() const {
+    return drawingEnabled;
+}
+
 bool CommandLineArgs::validateArguments() const {
-    return validatePath(modelPath) && validatePath(videoPath);
+    return validatePath(modelPath) && validatePath(videoPath)
+           && (onnxModelPath.empty() || validatePath(onnxModelPath))
+           && (evaluateModelPath.empty() || validatePath(evaluateModelPath));
 }
 
 void CommandLineArgs::printUsage(const char *programName) {
-    std::cerr << "Usage: " << programName << " --modelPath:<path> --videoPath:<path> --threshold:<value>" << std::endl;
+    std::cerr << "Usage: " << programName << " --modelPath:<path> --videoPath:<path> --threshold:<value>"
+              << " [--nmsThreshold:<value>]"
+              << " [--eventQueue:<mutex|ring>] [--dispatchThreads:<n>]"
+              << " [--queueCapacity:<n>] [--queuePolicy:<block|dropOldest|dropNewest|latest>]"
+              << " [--defogWorkers:<n>] [--defogPrecision:<float|fixed>]"
+              << " [--guidedSubsample:<n>] [--defogTemporal:<on|off>] [--lightInterval:<n>]"
+              << " [--lightSmoothing:<weight>] [--transmissionInterval:<n>] [--transmissionScale:<n>]"
+              << " [--inferenceWorkers:<n>]"
+              << " [--batchSize:<n>] [--batchTimeoutMs:<ms>] [--inputSize:<n>]"
+              << " [--modelLoading:<read|mmap>] [--onnxModel:<path>]"
+              << " [--backend:<opencv|openvino|halide>] [--precision:<fp32|fp16|int8>]"
+              << " [--evaluate] [--evaluateModel:<path>]"
+              << " [--detectionStride:<n>] [--strideMode:<fixed|adaptive>]"
+              << " [--motionGate:<on|off>] [--motionThreshold:<fraction>]"
+              << " [--metrics:<stdout|path>] [--metricsFormat:<prometheus|json>] [--metricsInterval:<seconds>]"
+              << " [--headless] [--output:<path>] [--maxFrames:<n>] [--realtime:<on|off>]"
+              << " [--draw:<on|off>]" << std::endl;
 }
 
 void CommandLineArgs::parseArguments(int argc, char *argv[]) {
@@ -33,6 +191,8 @@ void CommandLineArgs::parseArguments(int argc, char *argv[]) {
             std::string key = arg.substr(0, pos);
             std::string value = arg.substr(pos + 1);
             args[key] = value;
+        } else {
+            args[arg] = ""; // Flag without a value, e.g. --headless
         }
     }
 
@@ -52,6 +212,260 @@ void CommandLineArgs::parseArguments(int argc, char *argv[]) {
             confidenceThreshold = 0.3; // Default to 0.3 if invalid
         }
     }
+    if (args.find("--nmsThreshold") != args.end()) {
+        try {
+            nmsThreshold = std::stod(args["--nmsThreshold"]);
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "Error: Invalid NMS threshold value." << std::endl;
+            nmsThreshold = 0.45;
+        }
+    }
+    if (args.find("--eventQueue") != args.end()) {
+        if (args["--eventQueue"] == "ring") {
+            eventQueueBackend = EventDispatcher::QueueBackend::LockFreeRing;
+        } else if (args["--eventQueue"] != "mutex") {
+            std::cerr << "Error: Invalid event queue '" << args["--eventQueue"] << "', using mutex." << std::endl;
+        }
+    }
+    if (args.find("--dispatchThreads") != args.end()) {
+        try {
+            dispatchThreads = std::max(1, std::stoi(args["--dispatchThreads"]));
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "Error: Invalid dispatch thread count." << std::endl;
+            dispatchThreads = 1;
+        }
+    }
+    if (args.find("--queueCapacity") != args.end()) {
+        try {
+            queueCapacity = static_cast<size_t>(std::max(0, std::stoi(args["--queueCapacity"])));
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "Error: Invalid queue capacity." << std::endl;
+            queueCapacity = 0;
+        }
+    }
+    if (args.find("--queuePolicy") != args.end()) {
+        const std::string& policy = args["--queuePolicy"];
+        if (policy == "block") {
+            queuePolicy = IProcessor::OverflowPolicy::Block;
+        } else if (policy == "dropOldest") {
+            queuePolicy = IProcessor::OverflowPolicy::DropOldest;
+        } else if (policy == "dropNewest") {
+            queuePolicy = IProcessor::OverflowPolicy::DropNewest;
+        } else if (policy == "latest") {
+            queuePolicy = IProcessor::OverflowPolicy::LatestOnly;
+        } else {
+            std::cerr << "Error: Invalid queue policy '" << policy << "', using block." << std::endl;
+        }
+    }
+    if (args.find("--defogWorkers") != args.end()) {
+        try {
+            defogWorkers = std::max(1, std::stoi(args["--defogWorkers"]));
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "Error: Invalid defogger worker count." << std::endl;
+            defogWorkers = 1;
+        }
+    }
+    if (args.find("--defogPrecision") != args.end()) {
+        if (args["--defogPrecision"] == "fixed") {
+            defogFixedPoint = true;
+        } else if (args["--defogPrecision"] != "float") {
+            std::cerr << "Error: Invalid defog precision '" << args["--defogPrecision"] << "', using float." << std::endl;
+        }
+    }
+    if (args.find("--guidedSubsample") != args.end()) {
+        try {
+            guidedSubsample = std::max(1, std::stoi(args["--guidedSubsample"]));
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "Error: Invalid guided filter subsampling factor." << std::endl;
+            guidedSubsample = 1;
+        }
+    }
+    if (args.find("--defogTemporal") != args.end()) {
+        if (args["--defogTemporal"] == "on") {
+            defogTemporal = true;
+        } else if (args["--defogTemporal"] != "off") {
+            std::cerr << "Error: Invalid temporal defogging value '" << args["--defogTemporal"] << "', using off." << std::endl;
+        }
+    }
+    if (args.find("--lightInterval") != args.end()) {
+        try {
+            lightInterval = std::max(1, std::stoi(args["--lightInterval"]));
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "Error: Invalid atmospheric light interval." << std::endl;
+            lightInterval = 30;
+        }
+    }
+    if (args.find("--lightSmoothing") != args.end()) {
+        try {
+            lightSmoothing = std::min(1.0, std::max(0.0, std::stod(args["--lightSmoothing"])));
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "Error: Invalid atmospheric light smoothing." << std::endl;
+            lightSmoothing = 0.1;
+        }
+    }
+    if (args.find("--transmissionInterval") != args.end()) {
+        try {
+            transmissionInterval = std::max(1, std::stoi(args["--transmissionInterval"]));
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "Error: Invalid transmission interval." << std::endl;
+            transmissionInterval = 1;
+        }
+    }
+    if (args.find("--transmissionScale") != args.end()) {
+        try {
+            transmissionScale = std::max(1, std::stoi(args["--transmissionScale"]));
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "Error: Invalid transmission scale." << std::endl;
+            transmissionScale = 1;
+        }
+    }
+    if (args.find("--inferenceWorkers") != args.end()) {
+        try {
+            inferenceWorkers = std::max(1, std::stoi(args["--inferenceWorkers"]));
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "Error: Invalid inference worker count." << std::endl;
+            inferenceWorkers = 1;
+        }
+    }
+    if (args.find("--batchSize") != args.end()) {
+        try {
+            batchSize = std::max(1, std::stoi(args["--batchSize"]));
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "Error: Invalid batch size." << std::endl;
+            batchSize = 1;
+        }
+    }
+    if (args.find("--batchTimeoutMs") != args.end()) {
+        try {
+            batchTimeoutMs = std::max(0, std::stoi(args["--batchTimeoutMs"]));
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "Error: Invalid batch timeout." << std::endl;
+            batchTimeoutMs = 10;
+        }
+    }
+    if (args.find("--inputSize") != args.end()) {
+        try {
+            int requested = std::stoi(args["--inputSize"]);
+            inputSize = std::max(32, (requested + 16) / 32 * 32);
+            if (inputSize != requested) {
+                std::cerr << "Error: Input size must be a multiple of 32, using " << inputSize << "." << std::endl;
+            }
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "Error: Invalid input size." << std::endl;
+            inputSize = 416;
+        }
+    }
+    if (args.find("--modelLoading") != args.end()) {
+        if (args["--modelLoading"] == "mmap") {
+            modelMemoryMapped = true;
+        } else if (args["--modelLoading"] != "read") {
+            std::cerr << "Error: Invalid model loading '" << args["--modelLoading"] << "', using read." << std::endl;
+        }
+    }
+    if (args.find("--onnxModel") != args.end()) {
+        onnxModelPath = args["--onnxModel"];
+    }
+    if (args.find("--evaluate") != args.end()) {
+        evaluation = true;
+    }
+    if (args.find("--evaluateModel") != args.end()) {
+        evaluateModelPath = args["--evaluateModel"];
+    }
+    if (args.find("--backend") != args.end()) {
+        const std::string& name = args["--backend"];
+        if (name == "openvino") {
+            backend = IDetector::Backend::OpenVINO;
+        } else if (name == "halide") {
+            backend = IDetector::Backend::Halide;
+        } else if (name != "opencv") {
+            std::cerr << "Error: Invalid backend '" << name << "', using opencv." << std::endl;
+        }
+    }
+    if (args.find("--precision") != args.end()) {
+        if (args["--precision"] == "fp16") {
+            precision = IDetector::Precision::FP16;
+        } else if (args["--precision"] == "int8") {
+            precision = IDetector::Precision::INT8;
+        } else if (args["--precision"] != "fp32") {
+            std::cerr << "Error: Invalid precision '" << args["--precision"] << "', using fp32." << std::endl;
+        }
+    }
+    if (args.find("--detectionStride") != args.end()) {
+        try {
+            detectionStride = std::max(1, std::stoi(args["--detectionStride"]));
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "Error: Invalid detection stride." << std::endl;
+            detectionStride = 1;
+        }
+    }
+    if (args.find("--strideMode") != args.end()) {
+        if (args["--strideMode"] == "adaptive") {
+            adaptiveStride = true;
+        } else if (args["--strideMode"] != "fixed") {
+            std::cerr << "Error: Invalid stride mode '" << args["--strideMode"] << "', using fixed." << std::endl;
+        }
+    }
+    if (args.find("--motionGate") != args.end()) {
+        if (args["--motionGate"] == "on") {
+            motionGateEnabled = true;
+        } else if (args["--motionGate"] != "off") {
+            std::cerr << "Error: Invalid motion gate value '" << args["--motionGate"] << "', using off." << std::endl;
+        }
+    }
+    if (args.find("--motionThreshold") != args.end()) {
+        try {
+            motionThreshold = std::min(1.0, std::max(0.0, std::stod(args["--motionThreshold"])));
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "Error: Invalid motion threshold." << std::endl;
+            motionThreshold = 0.002;
+        }
+    }
+    if (args.find("--metrics") != args.end()) {
+        metricsTarget = args["--metrics"];
+    }
+    if (args.find("--metricsFormat") != args.end()) {
+        if (args["--metricsFormat"] == "json") {
+            metricsFormat = MetricsReporter::Format::Json;
+        } else if (args["--metricsFormat"] != "prometheus") {
+            std::cerr << "Error: Invalid metrics format '" << args["--metricsFormat"] << "', using prometheus." << std::endl;
+        }
+    }
+    if (args.find("--metricsInterval") != args.end()) {
+        try {
+            metricsInterval = std::max(0.1, std::stod(args["--metricsInterval"]));
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "Error: Invalid metrics interval." << std::endl;
+            metricsInterval = 5.0;
+        }
+    }
+    if (args.find("--headless") != args.end()) {
+        headless = true;
+    }
+    if (args.find("--output") != args.end()) {
+        outputPath = args["--output"];
+    }
+    if (args.find("--maxFrames") != args.end()) {
+        try {
+            maxFrames = static_cast<uint64_t>(std::max(0LL, std::stoll(args["--maxFrames"])));
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "Error: Invalid frame limit." << std::endl;
+            maxFrames = 0;
+        }
+    }
+    if (args.find("--realtime") != args.end()) {
+        if (args["--realtime"] == "off") {
+            realtime = false;
+        } else if (args["--realtime"] != "on") {
+            std::cerr << "Error: Invalid realtime value '" << args["--realtime"] << "', using on." << std::endl;
+        }
+    }
+    if (args.find("--draw") != args.end()) {
+        if (args["--draw"] == "off") {
+            drawingEnabled = false;
+        } else if (args["--draw"] != "on") {
+            std::cerr << "Error: Invalid draw value '" << args["--draw"] << "', using on." << std::endl;
+        }
+    }
 }
 
 bool CommandLineArgs::validatePath(const std::string &path) const {
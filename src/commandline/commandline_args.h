@@ -6,6 +6,10 @@
 #include <regex>
 #include <string>
 #include <unordered_map>
+#include "event_dispatcher.h"
+#include "iprocessor.h"
+#include "metrics_reporter.h"
+#include "idetector.h"
 
 /*!
  * \brief Parses and manages command-line arguments for an application.
@@ -44,6 +48,216 @@ public:
      */
     double getConfidenceThreshold() const;
 
+    /*!
+     * \brief Gets the IoU threshold of the Non-Maximum Suppression.
+     * \return The IoU above which overlapping boxes of the same class are suppressed.
+     */
+    double getNmsThreshold() const;
+
+    /*!
+     * \brief Gets the event queue implementation specified in the command-line arguments.
+     * \return The queue backend the EventDispatcher should be constructed with.
+     */
+    EventDispatcher::QueueBackend getEventQueueBackend() const;
+
+    /*!
+     * \brief Gets the number of event dispatch threads specified in the command-line arguments.
+     * \return The number of threads the EventDispatcher dispatches events on.
+     */
+    int getDispatchThreads() const;
+
+    /*!
+     * \brief Gets the per-stage queue capacity specified in the command-line arguments.
+     * \return Maximum number of frames queued in front of each stage; 0 means unbounded.
+     */
+    size_t getQueueCapacity() const;
+
+    /*!
+     * \brief Gets the policy applied when a stage queue is full.
+     * \return The overflow policy given to every processor.
+     */
+    IProcessor::OverflowPolicy getQueuePolicy() const;
+
+    /*!
+     * \brief Gets the number of defogger worker threads specified in the command-line arguments.
+     * \return Number of threads running the defogger concurrently.
+     */
+    int getDefogWorkers() const;
+
+    /*!
+     * \brief Gets whether the defogger runs its 8-bit fixed-point path.
+     * \return True if `--defogPrecision:fixed` was given.
+     */
+    bool isDefogFixedPoint() const;
+
+    /*!
+     * \brief Gets the subsampling factor of the guided filter refining the transmission.
+     * \return The factor, 1 for the full-resolution filter.
+     */
+    int getGuidedSubsample() const;
+
+    /*!
+     * \brief Gets whether the defogger reuses the atmospheric light and the transmission map across frames.
+     * \return True if `--defogTemporal:on` was given.
+     */
+    bool isDefogTemporal() const;
+
+    /*!
+     * \brief Gets the number of frames between two estimates of the atmospheric light in the temporal mode.
+     * \return The interval, at least 1.
+     */
+    int getLightInterval() const;
+
+    /*!
+     * \brief Gets the weight of a new estimate in the smoothed atmospheric light of the temporal mode.
+     * \return The weight, between 0 and 1.
+     */
+    double getLightSmoothing() const;
+
+    /*!
+     * \brief Gets the number of frames between two transmission maps in the temporal mode.
+     * \return The interval, 1 for a map per frame.
+     */
+    int getTransmissionInterval() const;
+
+    /*!
+     * \brief Gets how many times the frame is shrunk for the transmission map in the temporal mode.
+     * \return The factor, 1 for the full resolution.
+     */
+    int getTransmissionScale() const;
+
+    /*!
+     * \brief Gets the number of inference worker threads specified in the command-line arguments.
+     * \return Number of threads running the inference engine concurrently.
+     */
+    int getInferenceWorkers() const;
+
+    /*!
+     * \brief Gets the maximum number of frames per inference forward pass.
+     * \return The batch size, at least 1.
+     */
+    int getBatchSize() const;
+
+    /*!
+     * \brief Gets how long the inference stage waits for a batch to fill.
+     * \return The batch timeout in milliseconds.
+     */
+    int getBatchTimeoutMs() const;
+
+    /*!
+     * \brief Gets the width and height of the network input.
+     * \return The input size in pixels, a multiple of 32.
+     */
+    int getInputSize() const;
+
+    /*!
+     * \brief Gets whether the model files are memory-mapped instead of read into memory.
+     * \return True if `--modelLoading:mmap` was given.
+     */
+    bool isModelMemoryMapped() const;
+
+    /*!
+     * \brief Gets the ONNX model to run instead of the Darknet YOLOv3 of the model directory.
+     * \return The path of the ONNX model, or an empty string for the Darknet model.
+     */
+    std::string getOnnxModelPath() const;
+
+    /*!
+     * \brief Gets the inference backend.
+     * \return The backend selected with `--backend`, OpenCV by default.
+     */
+    IDetector::Backend getBackend() const;
+
+    /*!
+     * \brief Gets the precision of the forward pass.
+     * \return The precision selected with `--precision`, FP32 by default.
+     */
+    IDetector::Precision getPrecision() const;
+
+    /*!
+     * \brief Gets whether the application compares detectors instead of running the pipeline.
+     * \return True if `--evaluate` was given.
+     */
+    bool isEvaluation() const;
+
+    /*!
+     * \brief Gets the model evaluated against the configured one.
+     * \return The path of the ONNX model, or an empty string to evaluate the configured model itself.
+     */
+    std::string getEvaluateModelPath() const;
+
+    /*!
+     * \brief Gets the stride of the frames the network runs on.
+     * \return The detection stride, at least 1.
+     */
+    int getDetectionStride() const;
+
+    /*!
+     * \brief Gets whether the detection stride only applies while the inference queue backs up.
+     * \return True if `--strideMode:adaptive` was given.
+     */
+    bool isAdaptiveStride() const;
+
+    /*!
+     * \brief Gets whether inference is skipped on frames where nothing moved.
+     * \return True if `--motionGate:on` was given.
+     */
+    bool isMotionGateEnabled() const;
+
+    /*!
+     * \brief Gets the fraction of changed pixels that counts as motion.
+     * \return The motion threshold, between 0 and 1.
+     */
+    double getMotionThreshold() const;
+
+    /*!
+     * \brief Gets where the pipeline metrics are reported.
+     * \return `stdout`, a file path, or an empty string when metrics reporting is disabled.
+     */
+    std::string getMetricsTarget() const;
+
+    /*!
+     * \brief Gets the format of the pipeline metrics reports.
+     * \return Prometheus text format or JSON.
+     */
+    MetricsReporter::Format getMetricsFormat() const;
+
+    /*!
+     * \brief Gets the time between two metrics reports.
+     * \return The report interval in seconds.
+     */
+    double getMetricsInterval() const;
+
+    /*!
+     * \brief Gets whether the pipeline runs without a window.
+     * \return True if `--headless` was given.
+     */
+    bool isHeadless() const;
+
+    /*!
+     * \brief Gets the video file the headless sink writes the processed frames to.
+     * \return The output path, or an empty string to discard the frames.
+     */
+    std::string getOutputPath() const;
+
+    /*!
+     * \brief Gets the number of frames after which the pipeline stops.
+     * \return The frame limit, or 0 to run until stopped.
+     */
+    uint64_t getMaxFrames() const;
+
+    /*!
+     * \brief Gets whether the video is read at its own frame rate.
+     * \return False if `--realtime:off` was given.
+     */
+    bool isRealtime() const;
+
+    /*!
+     * \brief Gets whether detections are drawn into the processed frames.
+     * \return False if `--draw:off` was given.
+     */
+    bool isDrawingEnabled() const;
+
     /*!
      * \brief Validates the command-line arguments.
      * \return True if the arguments are valid; otherwise, false.
@@ -111,6 +325,220 @@ private:
     * \details Specifies the minimum confidence score required for a prediction to be considered valid. The default value is 0.3.
     */
     double confidenceThreshold = 0.3;
+
+    /*!
+    * \brief IoU threshold of the Non-Maximum Suppression.
+    * \details Selected with `--nmsThreshold:<value>`. The default is 0.45.
+    */
+    double nmsThreshold = 0.45;
+
+    /*!
+    * \brief Queue implementation used by the EventDispatcher.
+    * \details Selected with `--eventQueue:mutex` or `--eventQueue:ring`. The default is the mutex guarded queue.
+    */
+    EventDispatcher::QueueBackend eventQueueBackend = EventDispatcher::QueueBackend::Mutex;
+
+    /*!
+    * \brief Number of event dispatch threads.
+    * \details Selected with `--dispatchThreads:<n>`. The default of 1 dispatches every event on the main thread.
+    */
+    int dispatchThreads = 1;
+
+    /*!
+    * \brief Maximum number of frames queued in front of each stage.
+    * \details Selected with `--queueCapacity:<n>`. The default of 0 keeps the queues unbounded.
+    */
+    size_t queueCapacity = 0;
+
+    /*!
+    * \brief Policy applied when a stage queue is full.
+    * \details Selected with `--queuePolicy:<block|dropOldest|dropNewest|latest>`. The default blocks the producer.
+    */
+    IProcessor::OverflowPolicy queuePolicy = IProcessor::OverflowPolicy::Block;
+
+    /*!
+    * \brief Number of defogger worker threads.
+    * \details Selected with `--defogWorkers:<n>`. Frames are reordered after the stage, so output order is unchanged.
+    */
+    int defogWorkers = 1;
+
+    /*!
+    * \brief Whether the defogger runs its 8-bit fixed-point path instead of the float one.
+    * \details Selected with `--defogPrecision:<float|fixed>`. The default keeps the float path.
+    */
+    bool defogFixedPoint = false;
+
+    /*!
+    * \brief Subsampling factor of the fast guided filter refining the transmission.
+    * \details Selected with `--guidedSubsample:<n>`. The default of 1 runs the filter at full resolution.
+    */
+    int guidedSubsample = 1;
+
+    /*!
+    * \brief Whether the defogger reuses the atmospheric light and the transmission map across frames.
+    * \details Selected with `--defogTemporal:<on|off>`. Disabled by default.
+    */
+    bool defogTemporal = false;
+
+    /*!
+    * \brief Frames between two estimates of the atmospheric light in the temporal mode.
+    * \details Selected with `--lightInterval:<n>`. A scene change triggers an estimate earlier.
+    */
+    int lightInterval = 30;
+
+    /*!
+    * \brief Weight of a new estimate in the exponentially smoothed atmospheric light.
+    * \details Selected with `--lightSmoothing:<weight>`. 1 uses every estimate as is.
+    */
+    double lightSmoothing = 0.1;
+
+    /*!
+    * \brief Frames between two transmission maps in the temporal mode.
+    * \details Selected with `--transmissionInterval:<n>`. The default of 1 computes a map per frame.
+    */
+    int transmissionInterval = 1;
+
+    /*!
+    * \brief Shrink factor of the frame the transmission map is computed on in the temporal mode.
+    * \details Selected with `--transmissionScale:<n>`. The default of 1 keeps the full resolution.
+    */
+    int transmissionScale = 1;
+
+    /*!
+    * \brief Number of inference worker threads.
+    * \details Selected with `--inferenceWorkers:<n>`. Each worker runs its own network instance, which holds its own
+    * copy of the weights: the model memory grows with the number of workers.
+    */
+    int inferenceWorkers = 1;
+
+    /*!
+    * \brief Maximum number of frames per inference forward pass.
+    * \details Selected with `--batchSize:<n>`. The default of 1 runs every frame on its own.
+    */
+    int batchSize = 1;
+
+    /*!
+    * \brief Milliseconds the inference stage waits for a batch to fill.
+    * \details Selected with `--batchTimeoutMs:<ms>`. The default is 10 ms.
+    */
+    int batchTimeoutMs = 10;
+
+    /*!
+    * \brief Width and height of the network input.
+    * \details Selected with `--inputSize:<n>`, e.g. 320, 416, 512 or 608; other values are rounded to a multiple of 32. The default is 416.
+    */
+    int inputSize = 416;
+
+    /*!
+    * \brief Whether the model files are memory-mapped instead of read into memory.
+    * \details Selected with `--modelLoading:<read|mmap>`. The default reads the files.
+    */
+    bool modelMemoryMapped = false;
+
+    /*!
+    * \brief ONNX model to run instead of the Darknet YOLOv3 of the model directory.
+    * \details Selected with `--onnxModel:<path>`, e.g. a YOLOv5 or YOLOv8 export. Class names and colors are still read
+    * from the model directory.
+    */
+    std::string onnxModelPath;
+
+    /*!
+    * \brief Inference backend.
+    * \details Selected with `--backend:<opencv|openvino|halide>`. Backends this OpenCV build lacks fall back to opencv.
+    */
+    IDetector::Backend backend = IDetector::Backend::OpenCV;
+
+    /*!
+    * \brief Precision of the forward pass.
+    * \details Selected with `--precision:<fp32|fp16|int8>`. FP16 needs OpenCV 4.8 and a CPU with half precision arithmetic;
+    * INT8 needs a quantized model.
+    */
+    IDetector::Precision precision = IDetector::Precision::FP32;
+
+    /*!
+    * \brief Whether the application compares detectors instead of running the pipeline.
+    * \details Selected with `--evaluate`. The configured model in FP32 on the OpenCV backend is the reference; the
+    * candidate runs with `--backend` and `--precision`, on `--evaluateModel` if given. `--maxFrames` limits the clip.
+    */
+    bool evaluation = false;
+
+    /*!
+    * \brief Model evaluated against the configured one, e.g. its INT8 ONNX export.
+    * \details Selected with `--evaluateModel:<path>`. Empty evaluates the configured model itself.
+    */
+    std::string evaluateModelPath;
+
+    /*!
+    * \brief The network runs on every n-th frame; the boxes of the others are tracked.
+    * \details Selected with `--detectionStride:<n>`. The default of 1 runs the network on every frame.
+    */
+    int detectionStride = 1;
+
+    /*!
+    * \brief Whether the detection stride only applies while the inference queue backs up.
+    * \details Selected with `--strideMode:<fixed|adaptive>`. The default applies the stride to every frame.
+    */
+    bool adaptiveStride = false;
+
+    /*!
+    * \brief Whether inference is skipped on frames where nothing moved.
+    * \details Selected with `--motionGate:<on|off>`. Disabled by default.
+    */
+    bool motionGateEnabled = false;
+
+    /*!
+    * \brief Fraction of the pixels of the downscaled grey frame that must change to count as motion.
+    * \details Selected with `--motionThreshold:<fraction>`. The default is 0.002.
+    */
+    double motionThreshold = 0.002;
+
+    /*!
+    * \brief Destination of the metrics reports.
+    * \details Selected with `--metrics:<stdout|path>`. Empty disables reporting.
+    */
+    std::string metricsTarget;
+
+    /*!
+    * \brief Format of the metrics reports.
+    * \details Selected with `--metricsFormat:<prometheus|json>`. The default is the Prometheus text format.
+    */
+    MetricsReporter::Format metricsFormat = MetricsReporter::Format::Prometheus;
+
+    /*!
+    * \brief Seconds between two metrics reports.
+    * \details Selected with `--metricsInterval:<seconds>`. The default is 5 seconds.
+    */
+    double metricsInterval = 5.0;
+
+    /*!
+    * \brief Whether the pipeline runs without a window.
+    * \details Selected with `--headless`. The GUI stage is replaced by a sink that counts, writes or discards the frames.
+    */
+    bool headless = false;
+
+    /*!
+    * \brief Video file written by the headless sink.
+    * \details Selected with `--output:<path>`. Empty discards the frames.
+    */
+    std::string outputPath;
+
+    /*!
+    * \brief Number of frames after which the headless sink stops the pipeline.
+    * \details Selected with `--maxFrames:<n>`. The default of 0 runs until the process is interrupted.
+    */
+    uint64_t maxFrames = 0;
+
+    /*!
+    * \brief Whether the video is read at its own frame rate.
+    * \details Selected with `--realtime:<on|off>`. Turning it off reads frames as fast as the pipeline accepts them.
+    */
+    bool realtime = true;
+
+    /*!
+    * \brief Whether detections are drawn into the processed frames.
+    * \details Selected with `--draw:<on|off>`. Turning it off skips the renderer stage; the detections still travel with every frame.
+    */
+    bool drawingEnabled = true;
 };
 
 #endif // COMMANDLINEARGS_H
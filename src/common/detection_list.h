@@ -0,0 +1,111 @@
+#ifndef DETECTIONLIST_H
+#define DETECTIONLIST_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/*!
+ * \brief Detection results of one frame, stored as a structure of arrays.
+ * \details Every array holds one entry per detection, so element `i` of all arrays describes the same
+ * box. Boxes are in pixels of the processed frame (`Event::data.second`). The arrays are fixed-size and
+ * stored inline, so a list never allocates: filling, copying and moving an Event costs no heap allocation.
+ * A frame keeps at most kCapacity detections, the top-k of the suppression; push() ignores the rest.
+ * Copies and moves only touch the first count entries, so an event without boxes moves as cheaply as
+ * before; the full capacity only shows in sizeof(Event), that is in the dispatcher ring slots.
+ */
+struct DetectionList {
+    /*!
+     * \brief Maximum number of detections of a frame.
+     * \details YOLO rarely keeps more than 30 to 50 boxes after NMS. 64 boxes take 1.5 KB per event.
+     */
+    static constexpr size_t kCapacity = 64;
+
+    /*!
+     * \brief Where the boxes of a frame come from.
+     */
+    enum class Origin : uint8_t {
+        Detected,   ///< The network ran on this frame.
+        Tracked,    ///< The network skipped this frame; the boxes were propagated from earlier detections.
+        Reused      ///< Nothing moved since the previous frame; its boxes were copied.
+    };
+
+    std::array<float, kCapacity> x;             ///< Left edge of each box.
+    std::array<float, kCapacity> y;             ///< Top edge of each box.
+    std::array<float, kCapacity> width;         ///< Width of each box.
+    std::array<float, kCapacity> height;        ///< Height of each box.
+    std::array<float, kCapacity> score;         ///< Confidence of each detection.
+    std::array<int32_t, kCapacity> classId;     ///< Index of the detected class in the class list.
+    uint32_t count = 0;                         ///< Number of detections; the entries past it are unspecified.
+    Origin origin = Origin::Detected;           ///< How the boxes were obtained.
+
+    /*!
+     * \brief Constructs an empty list; the entries are left uninitialized.
+     */
+    DetectionList() {}
+
+    /*!
+     * \brief Copies the detections of another list, only the first count entries of each array.
+     * \details Also used for moves, which cannot do better with inline arrays.
+     */
+    DetectionList(const DetectionList& other) noexcept { *this = other; }
+
+    /*!
+     * \brief Replaces the detections with those of another list, only the first count entries of each array.
+     */
+    DetectionList& operator=(const DetectionList& other) noexcept {
+        count = other.count;
+        origin = other.origin;
+        std::copy_n(other.x.begin(), count, x.begin());
+        std::copy_n(other.y.begin(), count, y.begin());
+        std::copy_n(other.width.begin(), count, width.begin());
+        std::copy_n(other.height.begin(), count, height.begin());
+        std::copy_n(other.score.begin(), count, score.begin());
+        std::copy_n(other.classId.begin(), count, classId.begin());
+        return *this;
+    }
+
+    /*!
+     * \brief Returns the number of detections.
+     */
+    size_t size() const { return count; }
+
+    /*!
+     * \brief Returns whether the list holds no detection.
+     */
+    bool empty() const { return count == 0; }
+
+    /*!
+     * \brief Returns whether the list holds kCapacity detections.
+     */
+    bool full() const { return count == kCapacity; }
+
+    /*!
+     * \brief Removes every detection and resets the origin to Detected.
+     */
+    void clear() {
+        origin = Origin::Detected;
+        count = 0;
+    }
+
+    /*!
+     * \brief Appends one detection.
+     * \return False if the list is full, in which case the detection is dropped.
+     */
+    bool push(float boxX, float boxY, float boxWidth, float boxHeight, float boxScore, int32_t boxClassId) {
+        if (full()) {
+            return false;
+        }
+        x[count] = boxX;
+        y[count] = boxY;
+        width[count] = boxWidth;
+        height[count] = boxHeight;
+        score[count] = boxScore;
+        classId[count] = boxClassId;
+        ++count;
+        return true;
+    }
+};
+
+#endif // DETECTIONLIST_H
@@ -1,51 +1,146 @@
 #include "event_dispatcher.h"
+#include <iostream>
 
-EventDispatcher::EventDispatcher()
-    : running(true)
-{}
+EventDispatcher::EventDispatcher(QueueBackend backend, size_t ringCapacity, size_t dispatchThreads)
+    : queueBackend(backend)
+    , running(true)
+{
+    size_t laneCount = std::max<size_t>(dispatchThreads, 1);
+    for (size_t i = 0; i < laneCount; ++i) {
+        std::unique_ptr<Lane> lane = std::make_unique<Lane>();
+        if (queueBackend == QueueBackend::LockFreeRing) {
+            lane->ringQueue = std::make_unique<MpscRingBuffer<Event>>(ringCapacity);
+        }
+        lanes.push_back(std::move(lane));
+    }
+}
 
 EventDispatcher::~EventDispatcher() {
-    running = false;
-    queueCondition.notify_all(); // Notify all threads waiting on the condition
+    shutdownEventloop(); // Notify all threads waiting on the condition
+    for (std::thread& thread : dispatchThreads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
 }
 
-void EventDispatcher::postEvent(const Event& event) {
+void EventDispatcher::postEvent(Event&& event) {
+    Lane& lane = laneFor(event);
+
+    if (queueBackend == QueueBackend::LockFreeRing) {
+        while (!lane.ringQueue->tryPush(std::move(event))) {
+            if (!running.load()) return; // Nobody will drain the ring anymore
+            std::this_thread::yield();
+        }
+
+        // Pairs with the fence in runRingEventloop: either the loop sees the new event before
+        // it sleeps, or we see it sleeping and wake it up.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (lane.consumerSleeping.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(lane.queueMutex);
+            lane.queueCondition.notify_one();
+        }
+        return;
+    }
+
     {
-        std::lock_guard<std::mutex> lock(queueMutex);
-        eventQueue.push(event);
+        std::lock_guard<std::mutex> lock(lane.queueMutex);
+        lane.eventQueue.push(std::move(event));
     }
-    queueCondition.notify_one(); // Notify one waiting thread
+    lane.queueCondition.notify_one(); // Notify one waiting thread
 }
 
-void EventDispatcher::registerHandler(Event::Type type, std::function<void (const Event &)> handler)
+void EventDispatcher::postEvent(const Event &event)
 {
-    handlerContainer[type] = handler;
+    postEvent(Event(event));
+}
+
+void EventDispatcher::registerHandler(Event::Type type, std::function<void (Event &&)> handler)
+{
+    handlerContainer[type] = std::move(handler);
 }
 
 void EventDispatcher::startEventloop() {
+    auto runLane = [this](Lane& lane) {
+        if (queueBackend == QueueBackend::LockFreeRing) {
+            runRingEventloop(lane);
+        } else {
+            runMutexEventloop(lane);
+        }
+    };
+
+    for (size_t i = 1; i < lanes.size(); ++i) {
+        dispatchThreads.emplace_back(runLane, std::ref(*lanes[i]));
+    }
+
+    runLane(*lanes[0]);
+
+    for (std::thread& thread : dispatchThreads) {
+        thread.join();
+    }
+    dispatchThreads.clear();
+    handlerContainer.clear();
+}
+
+void EventDispatcher::shutdownEventloop()
+{
+    running.store(false);
+    for (std::unique_ptr<Lane>& lane : lanes) {
+        std::lock_guard<std::mutex> lock(lane->queueMutex);
+        lane->queueCondition.notify_all();
+    }
+}
+
+EventDispatcher::Lane &EventDispatcher::laneFor(const Event &event)
+{
+    // FIFO order is kept per source and type; different pipelines spread over the lanes
+    size_t key = static_cast<size_t>(event.sourceId) * Event::kTypeCount + static_cast<size_t>(event.type);
+    return *lanes[key % lanes.size()];
+}
+
+void EventDispatcher::dispatchEvent(Event &&event)
+{
+    auto it = handlerContainer.find(event.type);
+    if (it != handlerContainer.end()) {
+        it->second(std::move(event)); // Call the handler function
+    } else {
+        std::cerr << "No handler registered for this event type!" << std::endl;
+    }
+}
+
+void EventDispatcher::runMutexEventloop(Lane &lane)
+{
     while (running.load()) {
-        std::unique_lock<std::mutex> lock(queueMutex);
-        queueCondition.wait(lock, [this]() { return !eventQueue.empty() || !running; });
+        std::unique_lock<std::mutex> lock(lane.queueMutex);
+        lane.queueCondition.wait(lock, [this, &lane]() { return !lane.eventQueue.empty() || !running; });
 
         if (!running) break; // Exit if dispatcher is not running
 
-        while (!eventQueue.empty()) {
-            Event event = eventQueue.front();
-            eventQueue.pop();
+        while (!lane.eventQueue.empty() && running.load()) {
+            Event event = std::move(lane.eventQueue.front());
+            lane.eventQueue.pop();
             lock.unlock();
-            auto it = handlerContainer.find(event.type);
-            if (it != handlerContainer.end()) {
-                it->second(event); // Call the handler function
-            } else {
-                std::cerr << "No handler registered for this event type!" << std::endl;
-            }
+            dispatchEvent(std::move(event));
             lock.lock();
         }
     }
 }
 
-void EventDispatcher::shutdownEventloop()
+void EventDispatcher::runRingEventloop(Lane &lane)
 {
-    handlerContainer.clear();
-    running.store(false);
+    while (running.load()) {
+        std::optional<Event> event = lane.ringQueue->tryPop();
+        if (event) {
+            dispatchEvent(std::move(*event));
+            continue;
+        }
+
+        lane.consumerSleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        {
+            std::unique_lock<std::mutex> lock(lane.queueMutex);
+            lane.queueCondition.wait(lock, [this, &lane]() { return !lane.ringQueue->empty() || !running; });
+        }
+        lane.consumerSleeping.store(false, std::memory_order_relaxed);
+    }
 }
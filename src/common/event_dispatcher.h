@@ -7,13 +7,25 @@
 #include <condition_variable>
 #include <functional>
 #include <memory>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include <map>
+#include <thread>
+#include <vector>
 #include <opencv2/opencv.hpp>
+#include "mpsc_ring_buffer.h"
+#include "detection_list.h"
 
 /*!
  * \brief Represents an event with a type and associated data.
  * \details The Event class encapsulates information about an event, including
  * its type and any associated data. This data is typically a pair of OpenCV matrices
- * representing original and processed images.
+ * representing original and processed images, and the detections found in the frame. Each event also carries the identity and
+ * timing of its frame: sequence number, capture time, source id and the time the frame
+ * entered, started and left every stage. The metadata and the detections (up to
+ * DetectionList::kCapacity boxes) are stored inline, so they add no heap allocation per event.
  */
 class Event {
 public:
@@ -24,18 +36,81 @@ public:
         InitialState,            ///< Event indicating initial state.
         FrameCaptureReady,       ///< Event indicating that frame capture is ready.
         FrameDefoggerReady,      ///< Event indicating that frame defogger is ready.
-        FrameDetectionReady      ///< Event indicating that frame detection is ready.
+        DetectionResultsReady,   ///< Event indicating that the detections of the frame are in Event::detections.
+        FrameDetectionReady      ///< Event indicating that the frame is ready for display, with detections drawn if enabled.
+    };
+
+    /*!
+     * \brief Number of event types, and of pipeline stages tracked in stageTimings.
+     * \details A stage is identified by the event type it consumes (see IProcessor::getAccessibleType);
+     * the capture stage consumes InitialState.
+     */
+    static constexpr size_t kTypeCount = static_cast<size_t>(Type::FrameDetectionReady) + 1;
+
+    /*!
+     * \brief Monotonic timestamps of one stage, in nanoseconds of std::chrono::steady_clock. Zero when not reached.
+     */
+    struct StageTiming {
+        int64_t enterNs = 0;    ///< The frame was queued in front of the stage.
+        int64_t startNs = 0;    ///< A worker took the frame from the queue.
+        int64_t exitNs = 0;     ///< The stage finished the frame.
     };
 
     /*!
      * \brief Constructs an Event with a specified type and associated data.
      * \param type The type of the event.
      * \param data A pair of OpenCV matrices representing the original and processed images.
+     * \details The pair is moved into the event, so passing an rvalue costs no Mat header copy.
      */
-    Event(Type type, std::pair<cv::Mat, cv::Mat> data) : type(type), data(data) {}
+    Event(Type type, std::pair<cv::Mat, cv::Mat> data) : type(type), data(std::move(data)) {}
+
+    /*!
+     * \brief Returns the number of Event copies made since program start.
+     * \return Count of copied events; each copy duplicated two cv::Mat headers.
+     * \details Every copy duplicates both Mat headers (two atomic refcount updates). The frame path
+     * moves events end to end, so this stays at zero unless a caller copies an event.
+     */
+    static uint64_t payloadCopyCount() { return CopyCounter::count.load(std::memory_order_relaxed); }
+
+    /*!
+     * \brief Returns the current time of the clock used by all event timestamps.
+     * \return Nanoseconds of std::chrono::steady_clock.
+     */
+    static int64_t monotonicNowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /*!
+     * \brief Returns the timing slot of the stage consuming the given event type.
+     * \param stage The event type consumed by the stage.
+     */
+    StageTiming& timing(Type stage) { return stageTimings[static_cast<size_t>(stage)]; }
+    const StageTiming& timing(Type stage) const { return stageTimings[static_cast<size_t>(stage)]; }
 
     Type type;                ///< Type of the event.
     std::pair<cv::Mat, cv::Mat> data; ///< Pair of OpenCV matrices for event data (original and processed images).
+    uint64_t sequenceId = 0;  ///< Index of the frame within its source, assigned at capture.
+    int64_t captureTimestampNs = 0; ///< Monotonic time the frame was captured, see monotonicNowNs().
+    uint32_t sourceId = 0;    ///< Identifier of the source (camera or stream) the frame comes from.
+    std::array<StageTiming, kTypeCount> stageTimings{}; ///< Per-stage timestamps, indexed by the consumed event type.
+    DetectionList detections; ///< Objects detected in the frame; filled by the InferenceEngine, empty before.
+    bool slotReserved = false; ///< The producer reserved a slot for this frame in the receiving stage, see IProcessor::acquireSlot().
+
+private:
+    /*!
+     * \brief Member whose copies are counted, so Event can keep its defaulted copy and move operations.
+     */
+    struct CopyCounter {
+        CopyCounter() = default;
+        CopyCounter(const CopyCounter&) { count.fetch_add(1, std::memory_order_relaxed); }
+        CopyCounter(CopyCounter&&) noexcept = default;
+        CopyCounter& operator=(const CopyCounter&) { count.fetch_add(1, std::memory_order_relaxed); return *this; }
+        CopyCounter& operator=(CopyCounter&&) noexcept = default;
+
+        static inline std::atomic<uint64_t> count{0}; ///< Number of Event copies, see payloadCopyCount().
+    };
+
+    CopyCounter copyCounter; ///< Counts copies of this event.
 };
 
 /*!
@@ -43,15 +118,31 @@ public:
  * \details The EventDispatcher class is responsible for posting events, registering
  * handlers for different event types, and running the event loop. It maintains a queue
  * of events, handles thread synchronization, and ensures events are processed and dispatched
- * to the appropriate handlers.
+ * to the appropriate handlers. Events can be dispatched by a pool of threads: each thread owns
+ * one lane (its own queue), and every (source, event type) pair is always routed to the same lane,
+ * so different types and different sources are dispatched in parallel while each pair keeps its
+ * FIFO order.
  */
 class EventDispatcher {
 public:
+    /*!
+     * \brief Enum to select the queue implementation behind postEvent.
+     */
+    enum class QueueBackend {
+        Mutex,          ///< Unbounded std::queue guarded by a mutex.
+        LockFreeRing    ///< Bounded lock-free multi-producer/single-consumer ring.
+    };
+
     /*!
      * \brief Constructs an EventDispatcher object.
+     * \param backend The queue implementation used to hand events to the event loop.
+     * \param ringCapacity Number of slots of each lock-free ring. Ignored by the mutex backend.
+     * \param dispatchThreads Number of threads dispatching events, including the one calling startEventloop.
      * \details Initializes the EventDispatcher, preparing it for use in posting and handling events.
+     * With the lock-free ring, producers never contend on a mutex; when the ring is full they yield
+     * until the event loop frees a slot.
      */
-    EventDispatcher();
+    explicit EventDispatcher(QueueBackend backend = QueueBackend::Mutex, size_t ringCapacity = 1024, size_t dispatchThreads = 1);
 
     /*!
      * \brief Destroys the EventDispatcher object.
@@ -62,8 +153,15 @@ public:
     /*!
      * \brief Posts an event to the dispatcher.
      * \param event The event to be posted.
-     * \details Adds an event to the event queue, making it available for processing by
-     * the event loop.
+     * \details Adds an event to the queue of the lane owning its source and type, making it available for
+     * processing by the event loop. The event is moved through the queue and into the handler,
+     * so its frames are never copied.
+     */
+    void postEvent(Event&& event);
+
+    /*!
+     * \brief Posts a copy of an event to the dispatcher.
+     * \param event The event to be copied and posted.
      */
     void postEvent(const Event& event);
 
@@ -72,14 +170,18 @@ public:
      * \param type The type of event for which the handler is being registered.
      * \param handler The function to handle events of the specified type.
      * \details Associates a function with a specific event type. When an event of that type
-     * is posted, the registered handler will be invoked to process the event.
+     * is posted, the registered handler will be invoked to process the event. The handler receives
+     * the event as an rvalue and may move its frames out. Handlers must be registered before
+     * startEventloop is called.
      */
-    void registerHandler(Event::Type type, std::function<void(const Event&)> handler);
+    void registerHandler(Event::Type type, std::function<void(Event&&)> handler);
 
     /*!
      * \brief Starts the event loop.
      * \details Begins processing events by entering the event loop. This loop continuously
-     * checks for new events and dispatches them to the appropriate handlers.
+     * checks for new events and dispatches them to the appropriate handlers. The calling thread
+     * serves the first lane and the remaining dispatch threads are started here; the call returns
+     * once all of them have stopped.
      */
     void startEventloop();
 
@@ -87,39 +189,78 @@ public:
      * \brief Shuts down the event loop.
      * \details Stops the event loop and performs necessary cleanup. This method ensures
      * that the event loop exits gracefully and all resources are properly released.
+     * It may be called from any thread, including from inside a handler.
      */
     void shutdownEventloop();
 
 private:
     /*!
-    * \brief Flag indicating whether the event loop is currently running.
-    * \details This atomic boolean variable is used to control the lifecycle of the event loop, allowing safe and thread-safe checks and updates of the running state.
+     * \brief Queue and synchronization state served by one dispatch thread.
+     */
+    struct Lane {
+        std::queue<Event> eventQueue;                     ///< Events waiting when the mutex backend is used.
+        std::mutex queueMutex;                            ///< Guards eventQueue and the sleeping handshake.
+        std::condition_variable queueCondition;           ///< Signalled when events arrive or on shutdown.
+        std::unique_ptr<MpscRingBuffer<Event>> ringQueue; ///< Events waiting when the lock-free backend is used.
+        std::atomic<bool> consumerSleeping{false};        ///< Set while the ring loop is blocked on queueCondition.
+    };
+
+    /*!
+     * \brief Selects the lane an event is queued on.
+     * \param event The event being posted.
+     * \return The lane owning the ordering key of the event.
+     */
+    Lane& laneFor(const Event& event);
+
+    /*!
+     * \brief Invokes the handler registered for the type of the given event.
+     * \param event The event to be dispatched.
+     */
+    void dispatchEvent(Event&& event);
+
+    /*!
+     * \brief Event loop body used with QueueBackend::Mutex.
+     * \param lane The lane drained by the calling thread.
+     */
+    void runMutexEventloop(Lane& lane);
+
+    /*!
+     * \brief Event loop body used with QueueBackend::LockFreeRing.
+     * \param lane The lane drained by the calling thread.
+     * \details Drains the ring without locking and only falls back to the condition variable
+     * when the ring is empty.
+     */
+    void runRingEventloop(Lane& lane);
+
+private:
+    /*!
+    * \brief Queue implementation selected at construction time.
     */
-    std::atomic<bool> running;
+    const QueueBackend queueBackend;
 
     /*!
-    * \brief Queue for storing events to be processed.
-    * \details This queue holds events that need to be processed. Events are enqueued by various parts of the system and dequeued by the event loop for handling.
+    * \brief Flag indicating whether the event loop is currently running.
+    * \details This atomic boolean variable is used to control the lifecycle of the event loop, allowing safe and thread-safe checks and updates of the running state.
     */
-    std::queue<Event> eventQueue;
+    std::atomic<bool> running;
 
     /*!
-    * \brief Mutex for synchronizing access to the event queue.
-    * \details This mutex ensures that access to the event queue is thread-safe, preventing race conditions and ensuring that only one thread can modify or read the queue at a time.
+    * \brief One lane per dispatch thread.
+    * \details Lane 0 is served by the thread calling startEventloop. Lanes are heap allocated because they hold mutexes and must not move.
     */
-    std::mutex queueMutex;
+    std::vector<std::unique_ptr<Lane>> lanes;
 
     /*!
-    * \brief Condition variable for waiting and notifying about new events.
-    * \details This condition variable allows threads to wait efficiently until new events are available in the queue, and to notify other threads when events are added.
+    * \brief Additional dispatch threads serving lanes 1..N-1.
     */
-    std::condition_variable queueCondition;
+    std::vector<std::thread> dispatchThreads;
 
     /*!
     * \brief Container for event handlers.
     * \details This map associates event types with their corresponding handler functions. It is used to register and dispatch handlers for different types of events.
+    * It is only read while the event loop runs and cleared once every dispatch thread has stopped.
     */
-    std::map<Event::Type, std::function<void(const Event&)>> handlerContainer;
+    std::map<Event::Type, std::function<void(Event&&)>> handlerContainer;
 };
 
 #endif // EVENTDISPATCHER_H
@@ -0,0 +1,135 @@
+#include "frame_pool.h"
+
+namespace {
+constexpr size_t kPageSize = 4096;
+constexpr size_t kDefaultMaxCachedBytes = size_t(512) << 20;
+}
+
+FramePool::FramePool()
+    : maxCachedBytes(kDefaultMaxCachedBytes)
+{
+}
+
+FramePool &FramePool::instance()
+{
+    static FramePool* pool = new FramePool();
+    return *pool;
+}
+
+cv::Mat FramePool::acquire(int rows, int cols, int type)
+{
+    cv::Mat mat;
+    mat.allocator = this;
+    mat.create(rows, cols, type);
+    return mat;
+}
+
+void FramePool::attach(cv::Mat &mat)
+{
+    mat.release();
+    mat.allocator = this;
+}
+
+void FramePool::setMaxCachedBytes(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(poolMutex);
+    maxCachedBytes = bytes;
+}
+
+FramePool::Stats FramePool::stats() const
+{
+    Stats result;
+    result.hits = hits.load();
+    result.misses = misses.load();
+    std::lock_guard<std::mutex> lock(poolMutex);
+    result.residentBytes = residentBytes;
+    result.cachedBytes = cachedBytes;
+    return result;
+}
+
+cv::UMatData *FramePool::allocate(int dims, const int *sizes, int type, void *data, size_t *step,
+                                  cv::AccessFlag, cv::UMatUsageFlags) const
+{
+    // Same layout computation as OpenCV's standard allocator
+    size_t total = CV_ELEM_SIZE(type);
+    for (int i = dims - 1; i >= 0; i--) {
+        if (step) {
+            if (data && step[i] != CV_AUTOSTEP) {
+                CV_Assert(total <= step[i]);
+                total = step[i];
+            } else {
+                step[i] = total;
+            }
+        }
+        total *= sizes[i];
+    }
+
+    cv::UMatData* u = new cv::UMatData(this);
+    u->size = total;
+    if (data) {
+        u->data = u->origdata = static_cast<uchar*>(data);
+        u->flags |= cv::UMatData::USER_ALLOCATED;
+        return u;
+    }
+
+    size_t bucket = bucketSize(total);
+    void* buffer = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        auto it = freeBuckets.find(bucket);
+        if (it != freeBuckets.end() && !it->second.empty()) {
+            buffer = it->second.back();
+            it->second.pop_back();
+            cachedBytes -= bucket;
+        } else {
+            residentBytes += bucket;
+        }
+    }
+
+    if (buffer) {
+        hits.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        misses.fetch_add(1, std::memory_order_relaxed);
+        buffer = cv::fastMalloc(bucket);
+    }
+
+    u->data = u->origdata = static_cast<uchar*>(buffer);
+    return u;
+}
+
+bool FramePool::allocate(cv::UMatData *data, cv::AccessFlag, cv::UMatUsageFlags) const
+{
+    return data != nullptr;
+}
+
+void FramePool::deallocate(cv::UMatData *data) const
+{
+    if (!data) return;
+
+    CV_Assert(data->urefcount == 0);
+    CV_Assert(data->refcount == 0);
+    if (!(data->flags & cv::UMatData::USER_ALLOCATED)) {
+        size_t bucket = bucketSize(data->size);
+        bool cached = false;
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            if (cachedBytes + bucket <= maxCachedBytes) {
+                freeBuckets[bucket].push_back(data->origdata);
+                cachedBytes += bucket;
+                cached = true;
+            } else {
+                residentBytes -= bucket;
+            }
+        }
+        if (!cached) {
+            cv::fastFree(data->origdata);
+        }
+        data->origdata = nullptr;
+    }
+    delete data;
+}
+
+size_t FramePool::bucketSize(size_t bytes)
+{
+    return (bytes + kPageSize - 1) / kPageSize * kPageSize;
+}
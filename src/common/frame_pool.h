@@ -0,0 +1,122 @@
+#ifndef FRAMEPOOL_H
+#define FRAMEPOOL_H
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <opencv2/core.hpp>
+
+/*!
+ * \brief Recycles the pixel buffers of pipeline cv::Mat objects.
+ * \details The FramePool is a cv::MatAllocator shared by every stage. Buffers are grouped in
+ * buckets by their size rounded up to a whole page; when the last Mat referencing a buffer is
+ * released the buffer goes back to its bucket instead of being freed, and the next Mat of the
+ * same size reuses it. At a steady resolution every frame therefore runs without malloc/free
+ * and without fresh page faults. Cached buffers are capped by setMaxCachedBytes().
+ */
+class FramePool : public cv::MatAllocator {
+public:
+    /*!
+     * \brief Snapshot of the pool counters.
+     */
+    struct Stats {
+        uint64_t hits = 0;          ///< Allocations served from a cached buffer.
+        uint64_t misses = 0;        ///< Allocations that needed a new buffer.
+        size_t residentBytes = 0;   ///< Bytes owned by the pool: buffers in use plus cached buffers.
+        size_t cachedBytes = 0;     ///< Bytes of idle buffers waiting for reuse.
+
+        /*!
+         * \brief Fraction of allocations served from the cache.
+         * \return A value between 0 and 1; 0 before the first allocation.
+         */
+        double hitRate() const { return hits + misses == 0 ? 0.0 : double(hits) / double(hits + misses); }
+    };
+
+    /*!
+     * \brief Returns the pool shared by all stages.
+     * \details The pool is never destroyed, so Mats released during static destruction still find their allocator.
+     */
+    static FramePool& instance();
+
+    /*!
+     * \brief Creates a Mat whose buffer is drawn from the pool.
+     * \param rows Number of rows.
+     * \param cols Number of columns.
+     * \param type OpenCV type of the elements.
+     * \return An uninitialized Mat backed by a recycled buffer when one is available.
+     */
+    cv::Mat acquire(int rows, int cols, int type);
+
+    /*!
+     * \brief Makes the next allocation of an empty Mat come from the pool.
+     * \param mat The Mat that is about to be filled by an OpenCV call (read, convertTo, blobFromImage...).
+     * \details Releases any current content, then sets the allocator; OpenCV functions writing into the Mat
+     * call create() on it, which then draws from the pool.
+     */
+    void attach(cv::Mat& mat);
+
+    /*!
+     * \brief Limits the amount of memory kept in idle buffers.
+     * \param bytes Maximum cached bytes; released buffers beyond it are freed.
+     */
+    void setMaxCachedBytes(size_t bytes);
+
+    /*!
+     * \brief Returns the current hit/miss counters and memory usage.
+     */
+    Stats stats() const;
+
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override;
+    bool allocate(cv::UMatData* data, cv::AccessFlag accessFlags, cv::UMatUsageFlags usageFlags) const override;
+    void deallocate(cv::UMatData* data) const override;
+
+private:
+    FramePool();
+
+    /*!
+     * \brief Rounds a buffer size up to the bucket it is stored in.
+     * \param bytes Requested size in bytes.
+     * \return The size rounded up to a multiple of the page size.
+     */
+    static size_t bucketSize(size_t bytes);
+
+private:
+    /*!
+     * \brief Guards freeBuckets and the byte counters.
+     */
+    mutable std::mutex poolMutex;
+
+    /*!
+     * \brief Idle buffers keyed by bucket size.
+     */
+    mutable std::unordered_map<size_t, std::vector<void*>> freeBuckets;
+
+    /*!
+     * \brief Bytes owned by the pool, in use or cached.
+     */
+    mutable size_t residentBytes = 0;
+
+    /*!
+     * \brief Bytes of idle buffers in freeBuckets.
+     */
+    mutable size_t cachedBytes = 0;
+
+    /*!
+     * \brief Upper bound for cachedBytes.
+     */
+    size_t maxCachedBytes;
+
+    /*!
+     * \brief Allocations served from freeBuckets.
+     */
+    mutable std::atomic<uint64_t> hits{0};
+
+    /*!
+     * \brief Allocations that needed a new buffer.
+     */
+    mutable std::atomic<uint64_t> misses{0};
+};
+
+#endif // FRAMEPOOL_H
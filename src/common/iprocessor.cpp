@@ -9,28 +9,251 @@ IProcessor::IProcessor(EventDispatcher &dispatcher)
 
 void IProcessor::start()
 {
+    stageMetrics = &MetricsRegistry::instance().stage(getStageName());
     running.store(true);
-    workerThread = getThreadInfo();
+    for (size_t i = 0; i < workerCount; ++i) {
+        workerThreads.push_back(getThreadInfo());
+    }
 }
 
 void IProcessor::stop()
 {
     running.store(false);
     queueCondition.notify_all(); // Wake up the thread if it's waiting
-    if (workerThread.joinable()) {
-        workerThread.join();
+    spaceCondition.notify_all(); // Release producers blocked on a full queue
+    for (std::thread& workerThread : workerThreads) {
+        if (workerThread.joinable()) {
+            workerThread.join();
+        }
     }
+    workerThreads.clear();
 }
 
-void IProcessor::handleEvent(const Event &event)
+void IProcessor::handleEvent(Event &&event)
 {
     if(event.type == Event::Type::InitialState){
         return;
     }
 
     if (event.type == getAccessibleType()) {
-        std::lock_guard<std::mutex> lock(queueMutex);
-        frameQueue.push(event.data);
+        std::unique_lock<std::mutex> lock(queueMutex);
+        if (overflowPolicy == OverflowPolicy::LatestOnly) {
+            countDroppedFrames(frameQueue.size());
+            frameQueue = std::queue<Event>();
+        } else if (queueCapacity > 0 && frameQueue.size() >= queueCapacity) {
+            // Block never waits here, on the dispatcher lane; its producers reserved a slot with acquireSlot()
+            switch (overflowPolicy) {
+            case OverflowPolicy::DropOldest:
+                while (frameQueue.size() >= queueCapacity) {
+                    frameQueue.pop();
+                    countDroppedFrames(1);
+                }
+                break;
+            case OverflowPolicy::DropNewest:
+                countDroppedFrames(1);
+                return;
+            default:
+                break;
+            }
+        }
+        event.timing(getAccessibleType()).enterNs = Event::monotonicNowNs();
+        frameQueue.push(std::move(event));
+        if (stageMetrics) stageMetrics->queueDepth.store(static_cast<int64_t>(frameQueue.size()));
         queueCondition.notify_one();
     }
 }
+
+void IProcessor::handleEvent(const Event &event)
+{
+    handleEvent(Event(event));
+}
+
+void IProcessor::setQueueLimit(size_t capacity, OverflowPolicy policy)
+{
+    std::lock_guard<std::mutex> lock(queueMutex);
+    queueCapacity = capacity;
+    overflowPolicy = policy;
+}
+
+void IProcessor::setDownstream(IProcessor *stage)
+{
+    downstream = stage;
+}
+
+bool IProcessor::acquireSlot(const std::atomic<bool> &keepWaiting, bool &reserved)
+{
+    reserved = false;
+    std::unique_lock<std::mutex> lock(queueMutex);
+    if (overflowPolicy != OverflowPolicy::Block || queueCapacity == 0) {
+        return true;
+    }
+    // Timed, since nothing notifies this stage when the caller stops
+    while (reservedSlots >= queueCapacity) {
+        if (!running.load() || !keepWaiting.load()) {
+            return false;
+        }
+        spaceCondition.wait_for(lock, std::chrono::milliseconds(50));
+    }
+    ++reservedSlots;
+    reserved = true;
+    return true;
+}
+
+uint64_t IProcessor::droppedFrames() const
+{
+    return droppedFrameCount.load();
+}
+
+void IProcessor::setWorkerCount(size_t count)
+{
+    workerCount = std::max<size_t>(count, 1);
+}
+
+std::optional<Event> IProcessor::waitForEvent(uint64_t &ticket)
+{
+    std::unique_lock<std::mutex> lock(queueMutex);
+    queueCondition.wait(lock, [this]() { return !frameQueue.empty() || !running.load(); });
+
+    if (!running.load()) return std::nullopt; // Exit if not running
+
+    std::optional<Event> event(std::move(frameQueue.front()));
+    frameQueue.pop();
+    ticket = nextTicket++;
+    releaseSlot(*event);
+    if (stageMetrics) stageMetrics->queueDepth.store(static_cast<int64_t>(frameQueue.size()));
+    lock.unlock();
+    spaceCondition.notify_one();
+
+    Event::StageTiming& timing = event->timing(getAccessibleType());
+    timing.startNs = Event::monotonicNowNs();
+    if (stageMetrics) stageMetrics->waitTimeNs.record(timing.startNs - timing.enterNs);
+    return event;
+}
+
+bool IProcessor::waitForEvents(std::vector<Event> &events, uint64_t &firstTicket, size_t maxCount, std::chrono::milliseconds timeout)
+{
+    events.clear();
+    maxCount = std::max<size_t>(maxCount, 1);
+
+    std::unique_lock<std::mutex> lock(queueMutex);
+    do {
+        queueCondition.wait(lock, [this]() { return !frameQueue.empty() || !running.load(); });
+        if (!running.load()) return false; // Exit if not running
+
+        // Give the queue until the deadline to fill the batch
+        if (maxCount > 1 && frameQueue.size() < maxCount) {
+            std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + timeout;
+            queueCondition.wait_until(lock, deadline, [this, maxCount]() { return frameQueue.size() >= maxCount || !running.load(); });
+            if (!running.load()) return false;
+        }
+    } while (frameQueue.empty()); // Another worker may have taken the frames meanwhile
+
+    firstTicket = nextTicket;
+    while (!frameQueue.empty() && events.size() < maxCount) {
+        events.push_back(std::move(frameQueue.front()));
+        frameQueue.pop();
+        ++nextTicket;
+        releaseSlot(events.back());
+    }
+    if (stageMetrics) stageMetrics->queueDepth.store(static_cast<int64_t>(frameQueue.size()));
+    lock.unlock();
+    spaceCondition.notify_all();
+
+    int64_t startNs = Event::monotonicNowNs();
+    for (Event& event : events) {
+        Event::StageTiming& timing = event.timing(getAccessibleType());
+        timing.startNs = startNs;
+        if (stageMetrics) stageMetrics->waitTimeNs.record(timing.startNs - timing.enterNs);
+    }
+    return true;
+}
+
+void IProcessor::publishEvent(uint64_t ticket, Event &&event)
+{
+    stampStageExit(event);
+    if (workerCount == 1) {
+        beforePublish(event);
+        postDownstream(std::move(event)); // A single worker already publishes in order
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(reorderMutex);
+    if (flushing || ticket != nextPublishTicket) {
+        reorderBuffer.emplace(ticket, std::move(event)); // Posted by the worker flushing up to this ticket
+        return;
+    }
+
+    // This worker becomes the only one posting. The posts run outside the reorder lock, since they may wait
+    // for a slot downstream, so the other workers can still park their results meanwhile.
+    flushing = true;
+    flushRun.push_back(std::move(event));
+    ++nextPublishTicket;
+    while (true) {
+        // Take the results that were waiting for this run, including the ones parked during the last posts
+        auto it = reorderBuffer.begin();
+        while (it != reorderBuffer.end() && it->first == nextPublishTicket) {
+            flushRun.push_back(std::move(it->second));
+            it = reorderBuffer.erase(it);
+            ++nextPublishTicket;
+        }
+        if (flushRun.empty()) {
+            break;
+        }
+        lock.unlock();
+
+        for (Event& ready : flushRun) {
+            beforePublish(ready);
+            postDownstream(std::move(ready));
+        }
+        flushRun.clear();
+        lock.lock();
+    }
+    flushing = false;
+}
+
+void IProcessor::postDownstream(Event &&event)
+{
+    event.slotReserved = false;
+    if (downstream && !downstream->acquireSlot(running, event.slotReserved)) {
+        return;
+    }
+    dispatcher.postEvent(std::move(event));
+}
+
+void IProcessor::releaseSlot(Event &event)
+{
+    // Only reserved events hold a slot; the others were never counted
+    if (event.slotReserved) {
+        --reservedSlots;
+        event.slotReserved = false;
+    }
+}
+
+void IProcessor::beforePublish(Event &)
+{
+}
+
+size_t IProcessor::queuedEventCount()
+{
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return frameQueue.size();
+}
+
+void IProcessor::stampStageExit(Event &event)
+{
+    Event::StageTiming& timing = event.timing(getAccessibleType());
+    timing.exitNs = Event::monotonicNowNs();
+    if (stageMetrics) {
+        stageMetrics->framesProcessed.fetch_add(1, std::memory_order_relaxed);
+        stageMetrics->processTimeNs.record(timing.exitNs - timing.startNs);
+        if (event.captureTimestampNs != 0) {
+            stageMetrics->sinceCaptureNs.record(timing.exitNs - event.captureTimestampNs);
+        }
+    }
+}
+
+void IProcessor::countDroppedFrames(uint64_t count)
+{
+    droppedFrameCount.fetch_add(count);
+    if (stageMetrics) stageMetrics->framesDropped.fetch_add(count, std::memory_order_relaxed);
+}
@@ -1,22 +1,45 @@
 #ifndef IPROCESSOR_H
 #define IPROCESSOR_H
 
+#include <chrono>
 #include <thread>
 #include <atomic>
+#include <map>
+#include <optional>
+#include <vector>
 #include "event_dispatcher.h"
+#include "metrics_registry.h"
 
 class IProcessor {
 public:
+    /*!
+     * \brief Enum to define what happens when an event arrives at a full frameQueue.
+     */
+    enum class OverflowPolicy {
+        Block,          ///< The producing stage waits before posting until the workers free a slot, see acquireSlot().
+        DropOldest,     ///< The oldest queued frame is discarded to make room.
+        DropNewest,     ///< The incoming frame is discarded.
+        LatestOnly      ///< Every queued frame is replaced by the incoming one.
+    };
+
     /*!
      * \brief Constructs an IProcessor with the given EventDispatcher.
      * \param dispatcher Reference to an EventDispatcher used for event handling.
      */
     IProcessor(EventDispatcher &dispatcher);
 
+    /*!
+     * \brief Destroys the IProcessor.
+     * \details Virtual so a stage can be owned through an IProcessor pointer. Derived classes call stop()
+     * in their own destructor, while processEvents is still theirs.
+     */
+    virtual ~IProcessor() = default;
+
     /*!
      * \brief Starts processing.
      * \details Initiates or activates the necessary processes for the component to perform its tasks.
      * This may involve setting up resources, starting background threads, or beginning data processing operations.
+     * One worker thread is started per setWorkerCount().
      */
     void start();
 
@@ -32,9 +55,61 @@ public:
      * \param event The event to be processed.
      * \details Processes and responds to the given event object. The specific handling logic depends on the event type
      * and the requirements of the component. The `event` parameter contains details about the event that needs to be processed.
+     * The event is moved into frameQueue, so its frames are handed to the worker thread without being copied.
+     */
+    void handleEvent(Event&& event);
+
+    /*!
+     * \brief Handles a copy of an event.
+     * \param event The event to be copied and processed.
      */
     void handleEvent(const Event& event);
 
+    /*!
+     * \brief Bounds the frameQueue of this processor.
+     * \param capacity Maximum number of queued frames; 0 keeps the queue unbounded.
+     * \param policy What to do with an event arriving at a full queue.
+     * \details Must be called before start(). LatestOnly always keeps at most one frame queued, whatever the capacity.
+     */
+    void setQueueLimit(size_t capacity, OverflowPolicy policy);
+
+    /*!
+     * \brief Sets the stage this one publishes its results to.
+     * \param stage The next stage, or nullptr.
+     * \details Must be called before start(). Under OverflowPolicy::Block, publishEvent takes a slot of the next stage
+     * with acquireSlot() before posting each result, so a full stage holds back the workers of this one instead of
+     * the dispatcher lane.
+     */
+    void setDownstream(IProcessor* stage);
+
+    /*!
+     * \brief Reserves room for one frame in this stage, waiting on the calling thread while it is full.
+     * \param keepWaiting Flag of the caller; the wait gives up once it is cleared.
+     * \param reserved Set to true if a slot was taken. The caller copies it into Event::slotReserved of the frame it
+     * posts, so the slot is freed when a worker takes that frame; frames posted without a slot are never counted.
+     * \return False if the wait was given up, because this stage or the caller stopped.
+     * \details Only waits under OverflowPolicy::Block with a capacity. The capacity then counts every frame reserved
+     * and not yet taken by a worker, including the ones still in the dispatcher queue, so the bound holds end to end.
+     * The producer calls it before posting (VideoProcessor before each capture, publishEvent for the other stages);
+     * handleEvent itself never waits, so the dispatcher lane keeps delivering the other event types.
+     */
+    bool acquireSlot(const std::atomic<bool>& keepWaiting, bool& reserved);
+
+    /*!
+     * \brief Returns the number of frames discarded by the overflow policy.
+     * \return Count of dropped frames since construction.
+     */
+    uint64_t droppedFrames() const;
+
+    /*!
+     * \brief Sets how many worker threads pull from the frameQueue.
+     * \param count Number of workers; values below 1 are treated as 1.
+     * \details Must be called before start(). With several workers frames are processed concurrently and
+     * publishEvent restores their queue order before they are posted, so the next stage sees them in order.
+     * Only stages whose processEvents keeps no state shared between frames should use more than one worker.
+     */
+    void setWorkerCount(size_t count);
+
 protected:
     /*!
      * \brief Gets the type of events the derived class can handle.
@@ -57,6 +132,87 @@ protected:
      */
     virtual std::thread getThreadInfo() = 0;
 
+    /*!
+     * \brief Gets the name of the stage implemented by the derived class.
+     * \return A short name, used as the `stage` label of the pipeline metrics.
+     */
+    virtual std::string getStageName() const = 0;
+
+    /*!
+     * \brief Waits for the next queued event and removes it from frameQueue.
+     * \param ticket Receives the position of the event in this stage's input order.
+     * \return The event, or an empty optional once the processor is stopping.
+     * \details Used by the worker threads of derived classes. Frees a slot for producers waiting in acquireSlot().
+     * Records the start time of this stage in the event.
+     */
+    std::optional<Event> waitForEvent(uint64_t& ticket);
+
+    /*!
+     * \brief Waits for up to maxCount queued events and removes them from frameQueue.
+     * \param events Receives the events, in queue order; cleared first.
+     * \param firstTicket Receives the ticket of the first event; the others follow consecutively.
+     * \param maxCount Maximum number of events taken at once.
+     * \param timeout How long to wait for more events once the first one is available.
+     * \return False once the processor is stopping, true with at least one event otherwise.
+     * \details Returns as soon as maxCount events are taken or the timeout expires. With a maxCount of 1 it
+     * behaves like waitForEvent. Every returned ticket must be published.
+     */
+    bool waitForEvents(std::vector<Event>& events, uint64_t& firstTicket, size_t maxCount, std::chrono::milliseconds timeout);
+
+    /*!
+     * \brief Posts the result of a frame to the dispatcher in input order.
+     * \param ticket The ticket returned by waitForEvent for this frame.
+     * \param event The event to be posted.
+     * \details Every ticket must be published exactly once. Results that finish ahead of an earlier ticket are held
+     * back until all earlier tickets have been published. With several workers one of them at a time flushes the
+     * ready results, outside the reorder lock: a flush waiting for a slot downstream does not keep the other workers
+     * from parking their results.
+     */
+    void publishEvent(uint64_t ticket, Event&& event);
+
+    /*!
+     * \brief Posts an event to the dispatcher once the downstream stage has room for it.
+     * \param event The event to be posted.
+     * \details Drops the event if the wait for a slot is given up because a stage stopped.
+     */
+    void postDownstream(Event&& event);
+
+    /*!
+     * \brief Called for every result in input order, right before it is posted to the dispatcher.
+     * \param event The event about to be posted.
+     * \details Lets a stage with several workers keep state that depends on the frame order. With more than one worker it
+     * runs on the flushing worker, one call at a time, and holds back the posting of the later results, so it must be
+     * short. Does nothing by default.
+     */
+    virtual void beforePublish(Event& event);
+
+    /*!
+     * \brief Returns the number of events waiting in frameQueue.
+     */
+    size_t queuedEventCount();
+
+    /*!
+     * \brief Frees the slot an event reserved in this stage, if it reserved one.
+     * \param event An event just taken from frameQueue; its Event::slotReserved is cleared.
+     * \details Must be called with queueMutex held.
+     */
+    void releaseSlot(Event& event);
+
+    /*!
+     * \brief Records the time the frame leaves this stage.
+     * \param event The event whose timing slot for this stage is updated.
+     * \details publishEvent calls it; terminal stages that do not publish call it themselves.
+     * The enter and start times are recorded by handleEvent and waitForEvent. Also records the process time and
+     * the time since capture in the stage metrics.
+     */
+    void stampStageExit(Event& event);
+
+    /*!
+     * \brief Counts frames discarded by the overflow policy in droppedFrames() and in the stage metrics.
+     * \param count Number of discarded frames.
+     */
+    void countDroppedFrames(uint64_t count);
+
 protected:
     /*!
      * \brief Reference to the EventDispatcher used for event management.
@@ -65,10 +221,16 @@ protected:
     EventDispatcher& dispatcher;
 
     /*!
-     * \brief Thread handling background processing tasks.
-     * \details This thread is responsible for executing tasks concurrently, such as processing frames or performing long-running operations.
+     * \brief Threads handling background processing tasks.
+     * \details These threads are responsible for executing tasks concurrently, such as processing frames or performing long-running operations.
+     * Each one runs processEvents and pulls from the shared frameQueue.
      */
-    std::thread workerThread;
+    std::vector<std::thread> workerThreads;
+
+    /*!
+     * \brief Number of worker threads started by start().
+     */
+    size_t workerCount = 1;
 
     /*!
      * \brief Atomic flag indicating whether the component is running.
@@ -78,10 +240,10 @@ protected:
 
     /*!
      * \brief Queue to hold frames for processing.
-     * \details This queue stores pairs of OpenCV matrices, where each pair represents two frames (e.g., current and previous) to be processed.
-     * Frames are processed in the order they are added to the queue.
+     * \details This queue stores the events received by the processor; each event carries a pair of OpenCV matrices (original and processed frame).
+     * Frames are processed in the order they are added to the queue. Workers move the event out, update its frames and type, and post it on.
      */
-    std::queue<std::pair<cv::Mat, cv::Mat>> frameQueue;
+    std::queue<Event> frameQueue;
 
     /*!
      * \brief Mutex for synchronizing access to the frameQueue.
@@ -95,6 +257,74 @@ protected:
      * \details Allows threads to efficiently wait until frames are available in the frameQueue, avoiding busy-waiting and reducing CPU usage.
      */
     std::condition_variable queueCondition;
+
+    /*!
+     * \brief Condition variable for producers waiting in acquireSlot() for room in this stage.
+     * \details Only used with OverflowPolicy::Block; signalled whenever a worker takes a frame or the processor stops.
+     */
+    std::condition_variable spaceCondition;
+
+    /*!
+     * \brief Frames reserved with acquireSlot() and not yet taken by a worker. Guarded by queueMutex.
+     * \details Only frames carrying Event::slotReserved give their slot back when they are taken.
+     */
+    size_t reservedSlots = 0;
+
+    /*!
+     * \brief Stage the results are published to, whose slots publishEvent reserves; may be null.
+     */
+    IProcessor* downstream = nullptr;
+
+    /*!
+     * \brief Maximum number of frames held by frameQueue; 0 means unbounded.
+     */
+    size_t queueCapacity = 0;
+
+    /*!
+     * \brief Policy applied when an event arrives at a full frameQueue.
+     */
+    OverflowPolicy overflowPolicy = OverflowPolicy::Block;
+
+    /*!
+     * \brief Number of frames discarded by the overflow policy.
+     */
+    std::atomic<uint64_t> droppedFrameCount{0};
+
+    /*!
+     * \brief Ticket handed out with the next event taken from frameQueue. Guarded by queueMutex.
+     */
+    uint64_t nextTicket = 0;
+
+    /*!
+     * \brief Ticket of the next event publishEvent may post. Guarded by reorderMutex.
+     */
+    uint64_t nextPublishTicket = 0;
+
+    /*!
+     * \brief Results finished ahead of nextPublishTicket, keyed by ticket.
+     */
+    std::map<uint64_t, Event> reorderBuffer;
+
+    /*!
+     * \brief Mutex guarding reorderBuffer, nextPublishTicket and flushing.
+     */
+    std::mutex reorderMutex;
+
+    /*!
+     * \brief Whether a worker is posting ready results. Guarded by reorderMutex.
+     * \details Only that worker posts, so the results leave in ticket order without holding the lock.
+     */
+    bool flushing = false;
+
+    /*!
+     * \brief Results being posted by the flushing worker; only touched by it.
+     */
+    std::vector<Event> flushRun;
+
+    /*!
+     * \brief Metrics of this stage in the MetricsRegistry, looked up by getStageName() in start().
+     */
+    StageMetrics* stageMetrics = nullptr;
 };
 
 #endif // IPROCESSOR_H
@@ -0,0 +1,89 @@
+#include "mapped_file.h"
+#include <iostream>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : address(std::exchange(other.address, nullptr))
+    , length(std::exchange(other.length, 0))
+{
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+    if (this != &other) {
+        close();
+        address = std::exchange(other.address, nullptr);
+        length = std::exchange(other.length, 0);
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string &path)
+{
+    close();
+
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        std::cerr << "Error opening file: " << path << std::endl;
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(descriptor, &status) != 0) {
+        std::cerr << "Error reading file: " << path << std::endl;
+        ::close(descriptor);
+        return false;
+    }
+
+    size_t fileSize = static_cast<size_t>(status.st_size);
+    if (fileSize == 0) {
+        ::close(descriptor); // Nothing to map; an empty file is a valid, empty mapping
+        return true;
+    }
+
+    void* mapping = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, descriptor, 0);
+    ::close(descriptor); // The mapping keeps the file referenced
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Error mapping file: " << path << std::endl;
+        return false;
+    }
+
+    // The advice values are not flags, so each one takes its own call; both are hints, the mapping works without them
+    if (madvise(mapping, fileSize, MADV_SEQUENTIAL) != 0) {
+        std::cerr << "Warning: madvise(MADV_SEQUENTIAL) failed for file: " << path << std::endl;
+    }
+    if (madvise(mapping, fileSize, MADV_WILLNEED) != 0) {
+        std::cerr << "Warning: madvise(MADV_WILLNEED) failed for file: " << path << std::endl;
+    }
+    address = mapping;
+    length = fileSize;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (address) {
+        munmap(address, length);
+    }
+    address = nullptr;
+    length = 0;
+}
+
+const char *MappedFile::data() const
+{
+    return static_cast<const char*>(address);
+}
+
+size_t MappedFile::size() const
+{
+    return length;
+}
@@ -0,0 +1,66 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+/*!
+ * \brief Read-only memory mapping of a whole file.
+ * \details The pages come straight from the page cache: nothing is copied at open time, pages are
+ * faulted in on first access, and processes mapping the same file share the same physical memory.
+ * The mapping is released on destruction.
+ */
+class MappedFile {
+public:
+    /*!
+     * \brief Constructs an empty mapping.
+     */
+    MappedFile() = default;
+
+    /*!
+     * \brief Unmaps the file.
+     */
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /*!
+     * \brief Takes over the mapping of another MappedFile, leaving it empty.
+     */
+    MappedFile(MappedFile&& other) noexcept;
+
+    /*!
+     * \brief Releases the current mapping and takes over the one of another MappedFile.
+     */
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /*!
+     * \brief Maps a file, replacing the current mapping.
+     * \param path The file to be mapped.
+     * \return False if the file could not be opened or mapped; the mapping is then empty.
+     * \details The kernel is told the file will be read sequentially and soon, so read-ahead starts right away.
+     */
+    bool open(const std::string& path);
+
+    /*!
+     * \brief Unmaps the file.
+     */
+    void close();
+
+    /*!
+     * \brief Returns the first byte of the file, or nullptr when empty.
+     */
+    const char* data() const;
+
+    /*!
+     * \brief Returns the size of the file in bytes.
+     */
+    size_t size() const;
+
+private:
+    void* address = nullptr;    ///< Start of the mapping.
+    size_t length = 0;          ///< Length of the mapping.
+};
+
+#endif // MAPPEDFILE_H
@@ -0,0 +1,115 @@
+#include "metrics_registry.h"
+#include <fstream>
+#include <unistd.h>
+
+void LatencyHistogram::record(int64_t value)
+{
+    uint64_t sample = value > 0 ? static_cast<uint64_t>(value) : 0;
+    buckets[bucketIndex(sample)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    valueSum.fetch_add(sample, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::count() const
+{
+    return total.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::sum() const
+{
+    return valueSum.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::percentile(double quantile) const
+{
+    uint64_t recorded = count();
+    if (recorded == 0) return 0.0;
+
+    uint64_t rank = static_cast<uint64_t>(quantile * static_cast<double>(recorded));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen > rank) {
+            uint64_t lower = bucketLowerBound(i);
+            uint64_t upper = i + 1 < kBucketCount ? bucketLowerBound(i + 1) : lower;
+            return 0.5 * (static_cast<double>(lower) + static_cast<double>(upper));
+        }
+    }
+    return static_cast<double>(bucketLowerBound(kBucketCount - 1));
+}
+
+size_t LatencyHistogram::bucketIndex(uint64_t value)
+{
+    constexpr uint64_t kLinearLimit = uint64_t(2) << kSubBucketBits;
+    if (value < kLinearLimit) {
+        return static_cast<size_t>(value); // Small values get one bucket each
+    }
+
+    int msb = 63;
+    while (!(value >> msb)) {
+        --msb;
+    }
+    int shift = msb - kSubBucketBits;
+    uint64_t subBucket = (value >> shift) & ((uint64_t(1) << kSubBucketBits) - 1);
+    return (static_cast<size_t>(shift + 1) << kSubBucketBits) + static_cast<size_t>(subBucket);
+}
+
+uint64_t LatencyHistogram::bucketLowerBound(size_t index)
+{
+    constexpr size_t kSubBuckets = size_t(1) << kSubBucketBits;
+    if (index < 2 * kSubBuckets) {
+        return index;
+    }
+    int shift = static_cast<int>(index >> kSubBucketBits) - 1;
+    uint64_t subBucket = index & (kSubBuckets - 1);
+    return (kSubBuckets + subBucket) << shift;
+}
+
+MetricsRegistry &MetricsRegistry::instance()
+{
+    static MetricsRegistry* registry = new MetricsRegistry();
+    return *registry;
+}
+
+StageMetrics &MetricsRegistry::stage(const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::unique_ptr<StageMetrics>& metrics = stages[name];
+    if (!metrics) {
+        metrics = std::make_unique<StageMetrics>();
+    }
+    return *metrics;
+}
+
+void MetricsRegistry::registerGauge(const std::string &name, const std::string &help, std::function<double ()> read)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    gauges[name] = CallbackGauge{help, std::move(read)};
+}
+
+void MetricsRegistry::forEachStage(const std::function<void (const std::string &, const StageMetrics &)> &visitor) const
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto& entry : stages) {
+        visitor(entry.first, *entry.second);
+    }
+}
+
+void MetricsRegistry::forEachGauge(const std::function<void (const std::string &, const std::string &, double)> &visitor) const
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto& entry : gauges) {
+        visitor(entry.first, entry.second.help, entry.second.read());
+    }
+}
+
+uint64_t MetricsRegistry::residentSetBytes()
+{
+    std::ifstream statm("/proc/self/statm");
+    uint64_t totalPages = 0;
+    uint64_t residentPages = 0;
+    if (!(statm >> totalPages >> residentPages)) {
+        return 0;
+    }
+    return residentPages * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+}
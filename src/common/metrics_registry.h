@@ -0,0 +1,155 @@
+#ifndef METRICSREGISTRY_H
+#define METRICSREGISTRY_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/*!
+ * \brief Lock-free latency histogram with HDR-style log-linear buckets.
+ * \details Every power of two is split into 8 linear sub-buckets, so any recorded value is
+ * reported with at most 12.5% relative error over the whole 64-bit range. Recording is a
+ * single relaxed atomic increment and never allocates.
+ */
+class LatencyHistogram {
+public:
+    /*!
+     * \brief Number of linear sub-buckets per power of two, as a bit count.
+     */
+    static constexpr int kSubBucketBits = 3;
+
+    /*!
+     * \brief Total number of buckets needed to cover 64-bit values.
+     */
+    static constexpr size_t kBucketCount = (64 - kSubBucketBits + 1) << kSubBucketBits;
+
+    /*!
+     * \brief Records one value.
+     * \param value The value to be recorded, typically nanoseconds. Negative values are recorded as 0.
+     */
+    void record(int64_t value);
+
+    /*!
+     * \brief Returns the number of recorded values.
+     */
+    uint64_t count() const;
+
+    /*!
+     * \brief Returns the sum of all recorded values.
+     */
+    uint64_t sum() const;
+
+    /*!
+     * \brief Estimates a quantile of the recorded values.
+     * \param quantile The quantile between 0 and 1 (0.99 for p99).
+     * \return The midpoint of the bucket holding the quantile, or 0 when empty.
+     */
+    double percentile(double quantile) const;
+
+    /*!
+     * \brief Maps a value to its bucket index.
+     */
+    static size_t bucketIndex(uint64_t value);
+
+    /*!
+     * \brief Returns the smallest value stored in a bucket.
+     */
+    static uint64_t bucketLowerBound(size_t index);
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketCount> buckets{}; ///< Count of values per bucket.
+    std::atomic<uint64_t> total{0};                          ///< Number of recorded values.
+    std::atomic<uint64_t> valueSum{0};                       ///< Sum of recorded values.
+};
+
+/*!
+ * \brief Counters, gauges and histograms describing one pipeline stage.
+ * \details All members are updated lock-free from the stage's hot path.
+ */
+struct StageMetrics {
+    std::atomic<uint64_t> framesProcessed{0};  ///< Frames that left the stage.
+    std::atomic<uint64_t> framesDropped{0};    ///< Frames discarded by the queue overflow policy.
+    std::atomic<int64_t> queueDepth{0};        ///< Frames currently waiting in front of the stage.
+    LatencyHistogram waitTimeNs;               ///< Time between entering the queue and a worker taking the frame.
+    LatencyHistogram processTimeNs;            ///< Time a worker spent on the frame.
+    LatencyHistogram sinceCaptureNs;           ///< Time from capture until the frame left the stage.
+};
+
+/*!
+ * \brief Process-wide registry of pipeline metrics.
+ * \details Stages look up their StageMetrics once by name and then update them without locking.
+ * Values owned by other components (frame pool, event copies...) are exported as gauges read
+ * through a callback when the metrics are reported.
+ */
+class MetricsRegistry {
+public:
+    /*!
+     * \brief Returns the registry shared by the whole process.
+     */
+    static MetricsRegistry& instance();
+
+    /*!
+     * \brief Returns the metrics of a stage, creating them on first use.
+     * \param name Name of the stage, used as the `stage` label when reporting.
+     * \return A reference that stays valid for the lifetime of the registry.
+     */
+    StageMetrics& stage(const std::string& name);
+
+    /*!
+     * \brief Registers a gauge whose value is read when the metrics are reported.
+     * \param name Metric name, e.g. `frame_pool_resident_bytes`.
+     * \param help One line description.
+     * \param read Callback returning the current value. Must be thread-safe.
+     */
+    void registerGauge(const std::string& name, const std::string& help, std::function<double()> read);
+
+    /*!
+     * \brief Calls visitor for every registered stage, in name order.
+     */
+    void forEachStage(const std::function<void(const std::string&, const StageMetrics&)>& visitor) const;
+
+    /*!
+     * \brief Calls visitor with the name, help and current value of every registered gauge, in name order.
+     */
+    void forEachGauge(const std::function<void(const std::string&, const std::string&, double)>& visitor) const;
+
+    /*!
+     * \brief Returns the resident set size of the process.
+     * \return Resident bytes read from /proc/self/statm, or 0 where it is not available.
+     */
+    static uint64_t residentSetBytes();
+
+private:
+    MetricsRegistry() = default;
+
+    /*!
+     * \brief A gauge read through a callback.
+     */
+    struct CallbackGauge {
+        std::string help;
+        std::function<double()> read;
+    };
+
+private:
+    /*!
+     * \brief Guards stages and gauges. Never taken on the hot path.
+     */
+    mutable std::mutex registryMutex;
+
+    /*!
+     * \brief Stage metrics by name. Heap allocated so references stay stable.
+     */
+    std::map<std::string, std::unique_ptr<StageMetrics>> stages;
+
+    /*!
+     * \brief Callback gauges by name.
+     */
+    std::map<std::string, CallbackGauge> gauges;
+};
+
+#endif // METRICSREGISTRY_H
@@ -0,0 +1,186 @@
+#include "metrics_reporter.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+struct StageReport {
+    std::string name;
+    uint64_t frames;
+    uint64_t dropped;
+    int64_t queueDepth;
+    double fps;
+    const StageMetrics* metrics;
+};
+
+const double kQuantiles[] = { 0.5, 0.9, 0.99 };
+
+void writePrometheusHistogram(std::ostringstream& out, const std::string& metric, const std::string& help,
+                              const std::vector<StageReport>& stages,
+                              const LatencyHistogram StageMetrics::* histogram) {
+    out << "# HELP " << metric << " " << help << "\n";
+    out << "# TYPE " << metric << " summary\n";
+    for (const StageReport& stage : stages) {
+        const LatencyHistogram& values = stage.metrics->*histogram;
+        for (double quantile : kQuantiles) {
+            out << metric << "{stage=\"" << stage.name << "\",quantile=\"" << quantile << "\"} "
+                << values.percentile(quantile) * 1e-9 << "\n";
+        }
+        out << metric << "_sum{stage=\"" << stage.name << "\"} " << static_cast<double>(values.sum()) * 1e-9 << "\n";
+        out << metric << "_count{stage=\"" << stage.name << "\"} " << values.count() << "\n";
+    }
+}
+
+void writeJsonHistogram(std::ostringstream& out, const char* name, const LatencyHistogram& values) {
+    out << "\"" << name << "\":{\"count\":" << values.count()
+        << ",\"p50_ms\":" << values.percentile(0.5) * 1e-6
+        << ",\"p90_ms\":" << values.percentile(0.9) * 1e-6
+        << ",\"p99_ms\":" << values.percentile(0.99) * 1e-6 << "}";
+}
+
+} // namespace
+
+MetricsReporter::MetricsReporter(MetricsRegistry &registry, Format format, const std::string &target, std::chrono::milliseconds interval)
+    : registry(registry)
+    , format(format)
+    , target(target)
+    , interval(interval)
+    , running(false)
+    , lastRender(std::chrono::steady_clock::now())
+{
+}
+
+MetricsReporter::~MetricsReporter()
+{
+    stop();
+}
+
+void MetricsReporter::start()
+{
+    running.store(true);
+    reporterThread = std::thread(&MetricsReporter::run, this);
+}
+
+void MetricsReporter::stop()
+{
+    if (!reporterThread.joinable()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        running.store(false);
+    }
+    wakeCondition.notify_all();
+    reporterThread.join();
+    writeReport();
+}
+
+std::string MetricsReporter::render()
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - lastRender).count();
+    lastRender = now;
+
+    std::vector<StageReport> stages;
+    registry.forEachStage([&](const std::string& name, const StageMetrics& metrics) {
+        uint64_t frames = metrics.framesProcessed.load();
+        uint64_t previous = lastFrames[name];
+        lastFrames[name] = frames;
+        double fps = elapsed > 0.0 ? static_cast<double>(frames - previous) / elapsed : 0.0;
+        stages.push_back({ name, frames, metrics.framesDropped.load(), metrics.queueDepth.load(), fps, &metrics });
+    });
+
+    std::ostringstream out;
+    if (format == Format::Prometheus) {
+        out << "# HELP pipeline_stage_frames_total Frames that left the stage.\n"
+            << "# TYPE pipeline_stage_frames_total counter\n";
+        for (const StageReport& stage : stages) {
+            out << "pipeline_stage_frames_total{stage=\"" << stage.name << "\"} " << stage.frames << "\n";
+        }
+        out << "# HELP pipeline_stage_dropped_total Frames discarded by the stage queue overflow policy.\n"
+            << "# TYPE pipeline_stage_dropped_total counter\n";
+        for (const StageReport& stage : stages) {
+            out << "pipeline_stage_dropped_total{stage=\"" << stage.name << "\"} " << stage.dropped << "\n";
+        }
+        out << "# HELP pipeline_stage_queue_depth Frames waiting in front of the stage.\n"
+            << "# TYPE pipeline_stage_queue_depth gauge\n";
+        for (const StageReport& stage : stages) {
+            out << "pipeline_stage_queue_depth{stage=\"" << stage.name << "\"} " << stage.queueDepth << "\n";
+        }
+        out << "# HELP pipeline_stage_fps Frames per second over the last report interval.\n"
+            << "# TYPE pipeline_stage_fps gauge\n";
+        for (const StageReport& stage : stages) {
+            out << "pipeline_stage_fps{stage=\"" << stage.name << "\"} " << stage.fps << "\n";
+        }
+        writePrometheusHistogram(out, "pipeline_stage_wait_seconds", "Time frames waited in the stage queue.",
+                                 stages, &StageMetrics::waitTimeNs);
+        writePrometheusHistogram(out, "pipeline_stage_process_seconds", "Time the stage spent on a frame.",
+                                 stages, &StageMetrics::processTimeNs);
+        writePrometheusHistogram(out, "pipeline_stage_since_capture_seconds", "Time from capture until the frame left the stage.",
+                                 stages, &StageMetrics::sinceCaptureNs);
+        registry.forEachGauge([&](const std::string& name, const std::string& help, double value) {
+            out << "# HELP " << name << " " << help << "\n"
+                << "# TYPE " << name << " gauge\n"
+                << name << " " << value << "\n";
+        });
+    } else {
+        out << "{\"stages\":{";
+        for (size_t i = 0; i < stages.size(); ++i) {
+            const StageReport& stage = stages[i];
+            out << (i ? "," : "") << "\"" << stage.name << "\":{"
+                << "\"frames\":" << stage.frames
+                << ",\"dropped\":" << stage.dropped
+                << ",\"queue_depth\":" << stage.queueDepth
+                << ",\"fps\":" << stage.fps << ",";
+            writeJsonHistogram(out, "wait", stage.metrics->waitTimeNs);
+            out << ",";
+            writeJsonHistogram(out, "process", stage.metrics->processTimeNs);
+            out << ",";
+            writeJsonHistogram(out, "since_capture", stage.metrics->sinceCaptureNs);
+            out << "}";
+        }
+        out << "},\"gauges\":{";
+        bool first = true;
+        registry.forEachGauge([&](const std::string& name, const std::string&, double value) {
+            out << (first ? "" : ",") << "\"" << name << "\":" << value;
+            first = false;
+        });
+        out << "}}\n";
+    }
+    return out.str();
+}
+
+void MetricsReporter::run()
+{
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    while (running.load()) {
+        wakeCondition.wait_for(lock, interval, [this]() { return !running.load(); });
+        if (!running.load()) break;
+        lock.unlock();
+        writeReport();
+        lock.lock();
+    }
+}
+
+void MetricsReporter::writeReport()
+{
+    std::string report = render();
+    if (target == "stdout") {
+        std::cout << report << std::flush;
+        return;
+    }
+
+    // Write next to the target and rename, so readers never see a partial report
+    std::string temporary = target + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Error opening file: " << temporary << std::endl;
+            return;
+        }
+        file << report;
+    }
+    std::rename(temporary.c_str(), target.c_str());
+}
@@ -0,0 +1,84 @@
+#ifndef METRICSREPORTER_H
+#define METRICSREPORTER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "metrics_registry.h"
+
+/*!
+ * \brief Periodically writes the content of a MetricsRegistry to stdout or a file.
+ * \details The reporter renders every stage (queue depth, fps, drops, wait/process/since-capture
+ * latency quantiles) and every callback gauge, either in the Prometheus text exposition format
+ * or as a JSON document. When writing to a file, the file is replaced on every report so it can
+ * be scraped (e.g. by the node_exporter textfile collector) or tailed.
+ */
+class MetricsReporter {
+public:
+    /*!
+     * \brief Enum to define the output format.
+     */
+    enum class Format {
+        Prometheus,     ///< Prometheus text exposition format.
+        Json            ///< One JSON object per report.
+    };
+
+    /*!
+     * \brief Constructs a MetricsReporter.
+     * \param registry The registry to be reported.
+     * \param format The output format.
+     * \param target `stdout`, or the path of the file to be written.
+     * \param interval Time between two reports.
+     */
+    MetricsReporter(MetricsRegistry& registry, Format format, const std::string& target, std::chrono::milliseconds interval);
+
+    /*!
+     * \brief Stops the reporter thread if it is still running.
+     */
+    ~MetricsReporter();
+
+    /*!
+     * \brief Starts the reporter thread.
+     */
+    void start();
+
+    /*!
+     * \brief Stops the reporter thread and writes one last report.
+     */
+    void stop();
+
+    /*!
+     * \brief Renders the current metrics in the configured format.
+     * \return The rendered text. The fps values cover the time since the previous call.
+     */
+    std::string render();
+
+private:
+    /*!
+     * \brief Body of the reporter thread.
+     */
+    void run();
+
+    /*!
+     * \brief Writes one report to the configured target.
+     */
+    void writeReport();
+
+private:
+    MetricsRegistry& registry;                     ///< Registry being reported.
+    Format format;                                 ///< Output format.
+    std::string target;                            ///< `stdout` or output file path.
+    std::chrono::milliseconds interval;            ///< Time between two reports.
+    std::thread reporterThread;                    ///< Thread writing the periodic reports.
+    std::atomic<bool> running;                     ///< Whether reporterThread should keep reporting.
+    std::mutex wakeMutex;                          ///< Guards the wait of reporterThread.
+    std::condition_variable wakeCondition;         ///< Wakes reporterThread early on stop().
+    std::chrono::steady_clock::time_point lastRender; ///< Time of the previous render, for fps.
+    std::map<std::string, uint64_t> lastFrames;    ///< Frames per stage at the previous render, for fps.
+};
+
+#endif // METRICSREPORTER_H
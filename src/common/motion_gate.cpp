@@ -0,0 +1,47 @@
+#include "motion_gate.h"
+#include <algorithm>
+#include <opencv2/imgproc.hpp>
+
+MotionGate::MotionGate(double changedFraction, int pixelThreshold, int thumbnailWidth)
+    : changedFraction(changedFraction)
+    , pixelThreshold(pixelThreshold)
+    , thumbnailWidth(std::max(thumbnailWidth, 8))
+{
+}
+
+bool MotionGate::hasMotion(uint32_t sourceId, const cv::Mat &frame)
+{
+    if (frame.empty()) {
+        return true;
+    }
+
+    // Shrink before the grey conversion, so it only touches the thumbnail
+    int width = std::min(thumbnailWidth, frame.cols);
+    int height = std::max(1, frame.rows * width / frame.cols);
+    cv::Mat shrunk;
+    cv::Mat thumbnail;
+    cv::resize(frame, shrunk, cv::Size(width, height), 0, 0, cv::INTER_AREA);
+    if (shrunk.channels() == 1) {
+        thumbnail = shrunk;
+    } else {
+        cv::cvtColor(shrunk, thumbnail, cv::COLOR_BGR2GRAY);
+    }
+
+    std::lock_guard<std::mutex> lock(gateMutex);
+    cv::Mat& reference = references[sourceId];
+    if (reference.size() != thumbnail.size()) {
+        reference = thumbnail;
+        return true;
+    }
+
+    cv::Mat difference;
+    cv::absdiff(thumbnail, reference, difference);
+    cv::threshold(difference, difference, pixelThreshold, 255, cv::THRESH_BINARY);
+    int changed = cv::countNonZero(difference);
+    if (changed <= changedFraction * static_cast<double>(thumbnail.total())) {
+        return false;
+    }
+
+    reference = thumbnail;
+    return true;
+}
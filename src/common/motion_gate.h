@@ -0,0 +1,45 @@
+#ifndef MOTIONGATE_H
+#define MOTIONGATE_H
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <opencv2/core.hpp>
+
+/*!
+ * \brief Cheap change detector that tells whether a frame differs from the last one that moved.
+ * \details The inference engine uses it to skip the network on still frames, and the defogger's history
+ * uses a coarse one to detect scene cuts. Every frame is shrunk to a small grey thumbnail and compared with the thumbnail of the last
+ * frame of its source that showed motion. The frame shows motion when more than a given fraction of
+ * the thumbnail pixels changed by more than a given number of grey levels; it then becomes the new
+ * reference. Comparing with the last moving frame rather than the previous one catches slow changes
+ * that stay below the threshold from one frame to the next. The area averaging of the shrink also
+ * removes most sensor noise. Thread-safe; the thumbnails are built outside the lock.
+ */
+class MotionGate {
+public:
+    /*!
+     * \brief Constructs a MotionGate.
+     * \param changedFraction Fraction of the thumbnail pixels that must change for the frame to show motion.
+     * \param pixelThreshold Grey level difference above which a thumbnail pixel counts as changed.
+     * \param thumbnailWidth Width of the thumbnail; the height keeps the aspect ratio of the frame.
+     */
+    explicit MotionGate(double changedFraction = 0.002, int pixelThreshold = 25, int thumbnailWidth = 160);
+
+    /*!
+     * \brief Tells whether a frame changed since the last moving frame of its source.
+     * \param sourceId The source of the frame.
+     * \param frame The BGR frame.
+     * \return True for the first frame of a source, after a size change, and when enough pixels changed.
+     */
+    bool hasMotion(uint32_t sourceId, const cv::Mat& frame);
+
+private:
+    double changedFraction;                             ///< Fraction of changed pixels that counts as motion.
+    int pixelThreshold;                                 ///< Grey level difference of a changed pixel.
+    int thumbnailWidth;                                 ///< Width of the thumbnails.
+    std::mutex gateMutex;                               ///< Guards references.
+    std::unordered_map<uint32_t, cv::Mat> references;   ///< Thumbnail of the last moving frame, by source id.
+};
+
+#endif // MOTIONGATE_H
@@ -0,0 +1,158 @@
+#ifndef MPSCRINGBUFFER_H
+#define MPSCRINGBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+/*!
+ * \brief Bounded lock-free multi-producer/single-consumer ring buffer.
+ * \details Every slot carries a sequence counter. Producers claim a slot with a single CAS on the
+ * enqueue position and publish it by storing the slot sequence, so concurrent producers never block
+ * each other and never take a lock. The single consumer reads slots strictly in order and needs no
+ * read-modify-write operation at all. The capacity is rounded up to the next power of two.
+ * \tparam T The element type. It only needs to be move constructible.
+ */
+template<typename T>
+class MpscRingBuffer {
+public:
+    /*!
+     * \brief Constructs a ring buffer able to hold at least \a capacity elements.
+     * \param capacity Requested number of slots, rounded up to a power of two (minimum 2).
+     */
+    explicit MpscRingBuffer(size_t capacity)
+        : mask(roundUpToPowerOfTwo(capacity) - 1)
+        , slots(new Slot[mask + 1])
+        , enqueuePos(0)
+        , dequeuePos(0)
+    {
+        for (size_t i = 0; i <= mask; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /*!
+     * \brief Destroys the ring buffer and every element still stored in it.
+     */
+    ~MpscRingBuffer()
+    {
+        while (tryPop()) {
+        }
+    }
+
+    MpscRingBuffer(const MpscRingBuffer&) = delete;
+    MpscRingBuffer& operator=(const MpscRingBuffer&) = delete;
+
+    /*!
+     * \brief Tries to append an element. Safe to call from any number of threads.
+     * \param value The element to be stored.
+     * \return False if the ring is full; the value is left untouched in that case.
+     */
+    template<typename U>
+    bool tryPush(U&& value)
+    {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Slot* slot = nullptr;
+        for (;;) {
+            slot = &slots[pos & mask];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // The consumer has not released this slot yet: full
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        new (&slot->storage) T(std::forward<U>(value));
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*!
+     * \brief Tries to remove the oldest element. Must only be called from the consumer thread.
+     * \return The element, or an empty optional if no published element is available.
+     */
+    std::optional<T> tryPop()
+    {
+        Slot& slot = slots[dequeuePos & mask];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != dequeuePos + 1) {
+            return std::nullopt;
+        }
+
+        T* item = std::launder(reinterpret_cast<T*>(&slot.storage));
+        std::optional<T> value(std::move(*item));
+        item->~T();
+        slot.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+        ++dequeuePos;
+        return value;
+    }
+
+    /*!
+     * \brief Checks whether the next slot holds a published element. Consumer thread only.
+     * \return True if a call to tryPop() would fail.
+     */
+    bool empty() const
+    {
+        return slots[dequeuePos & mask].sequence.load(std::memory_order_acquire) != dequeuePos + 1;
+    }
+
+    /*!
+     * \brief Returns the number of slots of the ring.
+     */
+    size_t capacity() const
+    {
+        return mask + 1;
+    }
+
+private:
+    /*!
+     * \brief One cell of the ring: the publication sequence and raw storage for one element.
+     */
+    struct Slot {
+        std::atomic<size_t> sequence;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    static size_t roundUpToPowerOfTwo(size_t value)
+    {
+        size_t result = 2;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+private:
+    /*!
+     * \brief Capacity minus one, used to wrap positions into slot indices.
+     */
+    const size_t mask;
+
+    /*!
+     * \brief Slot storage, allocated once at construction.
+     */
+    std::unique_ptr<Slot[]> slots;
+
+    /*!
+     * \brief Next position to be claimed by a producer. Kept on its own cache line.
+     */
+    alignas(64) std::atomic<size_t> enqueuePos;
+
+    /*!
+     * \brief Next position to be read by the consumer. Only touched by the consumer thread.
+     */
+    alignas(64) size_t dequeuePos;
+};
+
+#endif // MPSCRINGBUFFER_H
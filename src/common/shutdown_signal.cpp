@@ -0,0 +1,45 @@
+#include "shutdown_signal.h"
+#include <chrono>
+#include <csignal>
+
+std::atomic<bool> ShutdownSignal::signalReceived(false);
+
+ShutdownSignal::ShutdownSignal(std::function<void ()> onShutdown)
+    : onShutdown(std::move(onShutdown))
+    , watching(true)
+{
+    std::signal(SIGINT, &ShutdownSignal::handleSignal);
+    std::signal(SIGTERM, &ShutdownSignal::handleSignal);
+    watcherThread = std::thread(&ShutdownSignal::watch, this);
+}
+
+ShutdownSignal::~ShutdownSignal()
+{
+    watching.store(false);
+    if (watcherThread.joinable()) {
+        watcherThread.join();
+    }
+}
+
+bool ShutdownSignal::requested()
+{
+    return signalReceived.load();
+}
+
+void ShutdownSignal::handleSignal(int signal)
+{
+    // Only async-signal-safe work here; the watcher thread does the rest
+    signalReceived.store(true);
+    std::signal(signal, SIG_DFL);
+}
+
+void ShutdownSignal::watch()
+{
+    while (watching.load()) {
+        if (signalReceived.load()) {
+            onShutdown();
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+}
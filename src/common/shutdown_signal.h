@@ -0,0 +1,52 @@
+#ifndef SHUTDOWNSIGNAL_H
+#define SHUTDOWNSIGNAL_H
+
+#include <atomic>
+#include <functional>
+#include <thread>
+
+/*!
+ * \brief Turns SIGINT and SIGTERM into a clean pipeline shutdown.
+ * \details The signal handler only sets a flag; a watcher thread notices it and runs the shutdown
+ * callback (typically EventDispatcher::shutdownEventloop) outside of the signal context.
+ * After the first signal the default disposition is restored, so a second one terminates the process.
+ */
+class ShutdownSignal {
+public:
+    /*!
+     * \brief Installs the signal handlers and starts the watcher thread.
+     * \param onShutdown Called once from the watcher thread when a signal arrives.
+     */
+    explicit ShutdownSignal(std::function<void()> onShutdown);
+
+    /*!
+     * \brief Stops the watcher thread. The signal handlers stay installed.
+     */
+    ~ShutdownSignal();
+
+    /*!
+     * \brief Returns whether SIGINT or SIGTERM has been received.
+     * \return True once a shutdown was requested.
+     */
+    static bool requested();
+
+private:
+    /*!
+     * \brief Signal handler; records the request and restores the default disposition.
+     * \param signal The received signal number.
+     */
+    static void handleSignal(int signal);
+
+    /*!
+     * \brief Body of the watcher thread.
+     */
+    void watch();
+
+private:
+    std::function<void()> onShutdown;              ///< Callback run when a signal arrives.
+    std::thread watcherThread;                     ///< Thread polling for a received signal.
+    std::atomic<bool> watching;                    ///< Whether watcherThread should keep polling.
+    static std::atomic<bool> signalReceived;       ///< Set by handleSignal.
+};
+
+#endif // SHUTDOWNSIGNAL_H
@@ -0,0 +1,85 @@
+#include "defog_history.h"
+#include <algorithm>
+
+DefogHistory::DefogHistory(uint32_t lightInterval, float lightSmoothing, uint32_t transmissionInterval,
+                           int transmissionScale, double sceneChangeFraction)
+    : lightInterval(std::max<uint32_t>(lightInterval, 1))
+    , lightSmoothing(std::min(1.0f, std::max(0.0f, lightSmoothing)))
+    , transmissionInterval(std::max<uint32_t>(transmissionInterval, 1))
+    , scale(std::max(transmissionScale, 1))
+    , sceneGate(sceneChangeFraction, 40, 64)
+{
+}
+
+DefogHistory::Plan DefogHistory::plan(uint32_t sourceId, uint64_t sequenceId, const cv::Mat &frame)
+{
+    // The gate has its own lock and builds its thumbnail outside of it
+    bool sceneChange = sceneGate.hasMotion(sourceId, frame);
+
+    std::lock_guard<std::mutex> lock(historyMutex);
+    SourceState& state = sources[sourceId];
+    Plan plan;
+    plan.resetLight = sceneChange || !state.lightPlanned;
+    plan.estimateLight = plan.resetLight || isDue(sequenceId, state.lightSequence, lightInterval);
+    if (plan.estimateLight) {
+        state.lightPlanned = true;
+        state.lightSequence = sequenceId;
+    }
+    plan.estimateTransmission = sceneChange || !state.transmissionPlanned
+                                || isDue(sequenceId, state.transmissionSequence, transmissionInterval);
+    if (plan.estimateTransmission) {
+        state.transmissionPlanned = true;
+        state.transmissionSequence = sequenceId;
+    }
+    return plan;
+}
+
+bool DefogHistory::light(uint32_t sourceId, float pA[])
+{
+    std::lock_guard<std::mutex> lock(historyMutex);
+    const SourceState& state = sources[sourceId];
+    if (!state.hasLight) {
+        return false;
+    }
+    std::copy(state.light, state.light + 3, pA);
+    return true;
+}
+
+void DefogHistory::blendLight(uint32_t sourceId, bool reset, float pA[])
+{
+    std::lock_guard<std::mutex> lock(historyMutex);
+    SourceState& state = sources[sourceId];
+    for (int i = 0; i < 3; ++i) {
+        state.light[i] = (reset || !state.hasLight) ? pA[i] : state.light[i] + lightSmoothing * (pA[i] - state.light[i]);
+        pA[i] = state.light[i];
+    }
+    state.hasLight = true;
+}
+
+bool DefogHistory::transmission(uint32_t sourceId, const cv::Size &size, int type, cv::Mat &pTransmission)
+{
+    std::lock_guard<std::mutex> lock(historyMutex);
+    const cv::Mat& stored = sources[sourceId].transmission;
+    if (stored.empty() || stored.size() != size || stored.type() != type) {
+        return false;
+    }
+    pTransmission = stored;
+    return true;
+}
+
+void DefogHistory::storeTransmission(uint32_t sourceId, const cv::Mat &pTransmission)
+{
+    std::lock_guard<std::mutex> lock(historyMutex);
+    sources[sourceId].transmission = pTransmission;
+}
+
+int DefogHistory::transmissionScale() const
+{
+    return scale;
+}
+
+bool DefogHistory::isDue(uint64_t sequenceId, uint64_t last, uint32_t interval)
+{
+    // An earlier frame means the source restarted
+    return sequenceId < last || sequenceId - last >= interval;
+}
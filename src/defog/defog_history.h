@@ -0,0 +1,120 @@
+#ifndef DEFOGHISTORY_H
+#define DEFOGHISTORY_H
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <opencv2/core.hpp>
+#include "motion_gate.h"
+
+/*!
+ * \brief Per-source memory of the temporal defogging mode.
+ * \details Fog changes far more slowly than the frame rate, so the atmospheric light A and the transmission
+ * map do not need to be estimated on every frame. For every source the history keeps an exponentially
+ * smoothed A, re-estimated every few frames, and the last transmission map, recomputed every few frames.
+ * Both are refreshed at once on a scene change, detected with a coarse MotionGate: a cut changes most
+ * pixels of a small thumbnail, which ordinary motion does not. Smoothing A also removes the flicker that
+ * independent per-frame estimates cause. Thread-safe, but plan() must see the frames of a source in order:
+ * the Defogger calls it in ticket order, whatever the number of workers. A frame whose plan relies on state
+ * another worker has not stored yet simply computes it.
+ */
+class DefogHistory {
+public:
+    /*!
+     * \brief What a frame estimates itself and what it takes from the history.
+     */
+    struct Plan {
+        bool estimateLight = true;          ///< A is estimated on this frame and blended into the smoothed one.
+        bool resetLight = true;             ///< The estimate replaces the smoothed A, on the first frame and after a cut.
+        bool estimateTransmission = true;   ///< The transmission map is computed on this frame.
+    };
+
+    /*!
+     * \brief Constructs a DefogHistory.
+     * \param lightInterval Number of frames between two estimates of A.
+     * \param lightSmoothing Weight of a new estimate of A in the smoothed one, between 0 and 1.
+     * \param transmissionInterval Number of frames between two transmission maps; 1 computes one per frame.
+     * \param transmissionScale The transmission map is computed on the frame shrunk this many times.
+     * \param sceneChangeFraction Fraction of the thumbnail pixels that must change for a cut.
+     */
+    DefogHistory(uint32_t lightInterval, float lightSmoothing, uint32_t transmissionInterval,
+                 int transmissionScale, double sceneChangeFraction = 0.5);
+
+    /*!
+     * \brief Decides what a frame estimates. Must be called in frame order for each source.
+     * \param sourceId The source of the frame.
+     * \param sequenceId Index of the frame within its source.
+     * \param frame The frame, for the scene change detection.
+     * \return The plan of the frame. Everything is estimated on the first frame of a source, after a cut and
+     * when the source restarts its sequence.
+     */
+    Plan plan(uint32_t sourceId, uint64_t sequenceId, const cv::Mat& frame);
+
+    /*!
+     * \brief Gets the smoothed atmospheric light of a source.
+     * \param sourceId The source.
+     * \param pA Receives A, in the 0-1 scale.
+     * \return False if no A was estimated for the source yet.
+     */
+    bool light(uint32_t sourceId, float pA[3]);
+
+    /*!
+     * \brief Blends a new estimate into the smoothed atmospheric light of a source.
+     * \param sourceId The source.
+     * \param reset True to replace the smoothed A with the estimate.
+     * \param pA The estimate in the 0-1 scale; receives the smoothed A.
+     */
+    void blendLight(uint32_t sourceId, bool reset, float pA[3]);
+
+    /*!
+     * \brief Gets the last transmission map of a source.
+     * \param sourceId The source.
+     * \param size Size of the frame the map is for.
+     * \param type Type of the map the defogging path works with.
+     * \param pTransmission Receives the map, shared and not to be modified.
+     * \return False if the source has no map of this size and type.
+     */
+    bool transmission(uint32_t sourceId, const cv::Size& size, int type, cv::Mat& pTransmission);
+
+    /*!
+     * \brief Keeps the transmission map of a source for the next frames.
+     * \param sourceId The source.
+     * \param pTransmission The map, which must not be modified afterwards.
+     */
+    void storeTransmission(uint32_t sourceId, const cv::Mat& pTransmission);
+
+    /*!
+     * \brief Returns how many times the frame is shrunk for the transmission map.
+     */
+    int transmissionScale() const;
+
+private:
+    /*!
+     * \brief State kept for one source.
+     */
+    struct SourceState {
+        bool lightPlanned = false;          ///< Whether A was planned for the source.
+        uint64_t lightSequence = 0;         ///< Frame of the last planned estimate of A.
+        bool hasLight = false;              ///< Whether light holds an estimate.
+        float light[3] = { 0, 0, 0 };       ///< Smoothed A, in the 0-1 scale.
+        bool transmissionPlanned = false;   ///< Whether a transmission map was planned for the source.
+        uint64_t transmissionSequence = 0;  ///< Frame of the last planned transmission map.
+        cv::Mat transmission;               ///< Last transmission map.
+    };
+
+    /*!
+     * \brief Tells whether an estimate planned on frame last is due again on frame sequenceId.
+     */
+    static bool isDue(uint64_t sequenceId, uint64_t last, uint32_t interval);
+
+private:
+    uint32_t lightInterval;                                 ///< Frames between two estimates of A.
+    float lightSmoothing;                                   ///< Weight of a new estimate of A.
+    uint32_t transmissionInterval;                          ///< Frames between two transmission maps.
+    int scale;                                              ///< Shrink factor of the transmission map.
+    MotionGate sceneGate;                                   ///< Detects the cuts.
+    std::mutex historyMutex;                                ///< Guards sources.
+    std::unordered_map<uint32_t, SourceState> sources;      ///< State by source id.
+};
+
+#endif // DEFOGHISTORY_H
@@ -0,0 +1,398 @@
+#include "defog_kernels.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <utility>
+#include <vector>
+#include <opencv2/core/hal/intrin.hpp>
+#include <opencv2/imgproc.hpp>
+
+namespace {
+
+// Maps a float to an unsigned key with the same order, negative values included
+inline uint32_t orderedKey(float pValue) {
+    pValue += 0.0f; // -0 becomes +0, the two compare equal
+    uint32_t tBits;
+    std::memcpy(&tBits, &pValue, sizeof(tBits));
+    return (tBits & 0x80000000u) ? ~tBits : (tBits | 0x80000000u);
+}
+
+// Walks a histogram from its top bin down to the bin holding the pRank-th largest element (1-based).
+// Returns the bin and leaves in pAbove the number of elements in the bins above it.
+int selectBin(const std::vector<uint32_t>& pHistogram, size_t pRank, size_t& pAbove) {
+    pAbove = 0;
+    for (int tBin = static_cast<int>(pHistogram.size()) - 1; tBin > 0; --tBin) {
+        if (pAbove + pHistogram[tBin] >= pRank) {
+            return tBin;
+        }
+        pAbove += pHistogram[tBin];
+    }
+    return 0;
+}
+
+// Element-wise minimum of two rows
+inline void minRows(const float* pA, const float* pB, float* pDst, int pCount) {
+    int i = 0;
+#if CV_SIMD
+    const int tLanes = cv::v_float32::nlanes;
+    for (; i + tLanes <= pCount; i += tLanes) {
+        cv::v_store(pDst + i, cv::v_min(cv::vx_load(pA + i), cv::vx_load(pB + i)));
+    }
+#endif
+    for (; i < pCount; ++i) {
+        pDst[i] = std::min(pA[i], pB[i]);
+    }
+}
+
+inline void minRows(const uchar* pA, const uchar* pB, uchar* pDst, int pCount) {
+    int i = 0;
+#if CV_SIMD
+    const int tLanes = cv::v_uint8::nlanes;
+    for (; i + tLanes <= pCount; i += tLanes) {
+        cv::v_store(pDst + i, cv::v_min(cv::vx_load(pA + i), cv::vx_load(pB + i)));
+    }
+#endif
+    for (; i < pCount; ++i) {
+        pDst[i] = std::min(pA[i], pB[i]);
+    }
+}
+
+// Minimum over the three channels of an interleaved row, each channel first divided by its divisor if any
+inline void minChannels(const float* pBgr, float* pDst, int pCount, const float* pDivisor) {
+    int i = 0;
+    if (pDivisor) {
+#if CV_SIMD
+        const int tLanes = cv::v_float32::nlanes;
+        const cv::v_float32 tD0 = cv::vx_setall_f32(pDivisor[0]);
+        const cv::v_float32 tD1 = cv::vx_setall_f32(pDivisor[1]);
+        const cv::v_float32 tD2 = cv::vx_setall_f32(pDivisor[2]);
+        for (; i + tLanes <= pCount; i += tLanes) {
+            cv::v_float32 tB, tG, tR;
+            cv::v_load_deinterleave(pBgr + 3 * i, tB, tG, tR);
+            cv::v_store(pDst + i, cv::v_min(cv::v_min(tB / tD0, tG / tD1), tR / tD2));
+        }
+#endif
+        for (; i < pCount; ++i) {
+            pDst[i] = std::min(std::min(pBgr[3 * i] / pDivisor[0], pBgr[3 * i + 1] / pDivisor[1]), pBgr[3 * i + 2] / pDivisor[2]);
+        }
+        return;
+    }
+#if CV_SIMD
+    const int tLanes = cv::v_float32::nlanes;
+    for (; i + tLanes <= pCount; i += tLanes) {
+        cv::v_float32 tB, tG, tR;
+        cv::v_load_deinterleave(pBgr + 3 * i, tB, tG, tR);
+        cv::v_store(pDst + i, cv::v_min(cv::v_min(tB, tG), tR));
+    }
+#endif
+    for (; i < pCount; ++i) {
+        pDst[i] = std::min(std::min(pBgr[3 * i], pBgr[3 * i + 1]), pBgr[3 * i + 2]);
+    }
+}
+
+// Quotients of every 8-bit value by the divisor of its channel, scaled by 255 and saturated. A divisor below 1
+// (a black frame gives A = 0) is taken as 1, like the recovery tables do, so no NaN reaches saturate_cast.
+void divisionTables(const float* pDivisor, uchar pLut[3][256]) {
+    for (int k = 0; k < 3; ++k) {
+        const float tScale = 255.0f / std::max(pDivisor[k], 1.0f);
+        for (int v = 0; v < 256; ++v) {
+            pLut[k][v] = cv::saturate_cast<uchar>(v * tScale);
+        }
+    }
+}
+
+inline void minChannels(const uchar* pBgr, uchar* pDst, int pCount, const uchar (*pLut)[256]) {
+    int i = 0;
+    if (pLut) {
+        for (; i < pCount; ++i) {
+            pDst[i] = std::min(std::min(pLut[0][pBgr[3 * i]], pLut[1][pBgr[3 * i + 1]]), pLut[2][pBgr[3 * i + 2]]);
+        }
+        return;
+    }
+#if CV_SIMD
+    const int tLanes = cv::v_uint8::nlanes;
+    for (; i + tLanes <= pCount; i += tLanes) {
+        cv::v_uint8 tB, tG, tR;
+        cv::v_load_deinterleave(pBgr + 3 * i, tB, tG, tR);
+        cv::v_store(pDst + i, cv::v_min(cv::v_min(tB, tG), tR));
+    }
+#endif
+    for (; i < pCount; ++i) {
+        pDst[i] = std::min(std::min(pBgr[3 * i], pBgr[3 * i + 1]), pBgr[3 * i + 2]);
+    }
+}
+
+// Van Herk/Gil-Werman running minimum of a padded line of pPadded = n + pSize - 1 values into n outputs.
+// pForward and pBackward are scratch of pPadded values.
+template <typename T>
+void runningMin(const T* pLine, int pPadded, int pSize, T* pForward, T* pBackward, T* pDst) {
+    // One block of pSize values at a time, so the inner loops carry no block test
+    for (int tBegin = 0; tBegin < pPadded; tBegin += pSize) {
+        const int tEnd = std::min(tBegin + pSize, pPadded);
+        pForward[tBegin] = pLine[tBegin];
+        for (int p = tBegin + 1; p < tEnd; ++p) {
+            pForward[p] = std::min(pForward[p - 1], pLine[p]);
+        }
+        pBackward[tEnd - 1] = pLine[tEnd - 1];
+        for (int p = tEnd - 2; p >= tBegin; --p) {
+            pBackward[p] = std::min(pBackward[p + 1], pLine[p]);
+        }
+    }
+    const int tCount = pPadded - pSize + 1;
+    for (int x = 0; x < tCount; ++x) {
+        pDst[x] = std::min(pBackward[x], pForward[x + pSize - 1]);
+    }
+}
+
+// pDivision is what minChannels takes for T: the divisors for float, the division tables for uchar
+template <typename T, typename D>
+void darkChannelOf(const cv::Mat& pSource, int pSize, cv::Mat& pDark, D pDivision) {
+    const int tRows = pSource.rows;
+    const int tCols = pSource.cols;
+    const int tAnchor = pSize / 2;
+    const T tInfinity = std::numeric_limits<T>::max(); // Neutral element, like the erode border
+    pDark.create(tRows, tCols, cv::DataType<T>::type);
+
+    // Row pass: the channel minimum goes into the middle of a padded line, then the running minimum
+    cv::Mat tRowMin(tRows, tCols, cv::DataType<T>::type);
+    const int tPadded = tCols + pSize - 1;
+    std::vector<T> tLine(tPadded, tInfinity);
+    std::vector<T> tForward(tPadded);
+    std::vector<T> tBackward(tPadded);
+    for (int r = 0; r < tRows; ++r) {
+        minChannels(pSource.ptr<T>(r), tLine.data() + tAnchor, tCols, pDivision);
+        runningMin(tLine.data(), tPadded, pSize, tForward.data(), tBackward.data(), tRowMin.ptr<T>(r));
+    }
+
+    // Column pass on whole rows. Padded row p is image row p - tAnchor, out of the image it is all tInfinity.
+    // For the block of output rows starting at s, the backward minimum runs over padded rows s..s+pSize-1
+    // and the forward minimum over the next block, and output row s+j is the minimum of both.
+    std::vector<T> tInfinityRow(tCols, tInfinity);
+    cv::Mat tBackwardRows(pSize, tCols, cv::DataType<T>::type);
+    cv::Mat tForwardRows(pSize, tCols, cv::DataType<T>::type);
+    const size_t tRowBytes = static_cast<size_t>(tCols) * sizeof(T);
+    auto paddedRow = [&](int p) -> const T* {
+        int tRow = p - tAnchor;
+        return (tRow >= 0 && tRow < tRows) ? tRowMin.ptr<T>(tRow) : tInfinityRow.data();
+    };
+    for (int s = 0; s < tRows; s += pSize) {
+        std::memcpy(tBackwardRows.ptr<T>(pSize - 1), paddedRow(s + pSize - 1), tRowBytes);
+        for (int j = pSize - 2; j >= 0; --j) {
+            minRows(tBackwardRows.ptr<T>(j + 1), paddedRow(s + j), tBackwardRows.ptr<T>(j), tCols);
+        }
+        const int tBlockRows = std::min(pSize, tRows - s);
+        if (tBlockRows > 1) {
+            std::memcpy(tForwardRows.ptr<T>(0), paddedRow(s + pSize), tRowBytes);
+            for (int j = 1; j < tBlockRows - 1; ++j) {
+                minRows(tForwardRows.ptr<T>(j - 1), paddedRow(s + pSize + j), tForwardRows.ptr<T>(j), tCols);
+            }
+        }
+        std::memcpy(pDark.ptr<T>(s), tBackwardRows.ptr<T>(0), tRowBytes);
+        for (int j = 1; j < tBlockRows; ++j) {
+            minRows(tBackwardRows.ptr<T>(j), tForwardRows.ptr<T>(j - 1), pDark.ptr<T>(s + j), tCols);
+        }
+    }
+#if CV_SIMD
+    cv::vx_cleanup();
+#endif
+}
+
+// Atmospheric light of an 8-bit image: one 256-bin histogram gives the threshold, the sums are exact integers
+void atmosphericLight8u(const cv::Mat& pSource, const cv::Mat& pDark, size_t pNumpx, float pOutA[3]) {
+    const int tRows = pDark.rows;
+    const int tCols = pDark.cols;
+    std::vector<uint32_t> tHistogram(256, 0);
+    for (int r = 0; r < tRows; ++r) {
+        const uchar* tDarkRow = pDark.ptr<uchar>(r);
+        for (int c = 0; c < tCols; ++c) {
+            ++tHistogram[tDarkRow[c]];
+        }
+    }
+    size_t tAbove = 0;
+    const int tThreshold = selectBin(tHistogram, pNumpx, tAbove);
+    size_t tTies = pNumpx - tAbove;
+
+    uint64_t tSum[3] = { 0, 0, 0 };
+    for (int r = tRows - 1; r >= 0; --r) {
+        const uchar* tDarkRow = pDark.ptr<uchar>(r);
+        const uchar* tSourceRow = pSource.ptr<uchar>(r);
+        for (int c = tCols - 1; c >= 0; --c) {
+            if (tDarkRow[c] < tThreshold || (tDarkRow[c] == tThreshold && tTies == 0)) {
+                continue;
+            }
+            if (tDarkRow[c] == tThreshold) {
+                --tTies;
+            }
+            tSum[0] += tSourceRow[3 * c];
+            tSum[1] += tSourceRow[3 * c + 1];
+            tSum[2] += tSourceRow[3 * c + 2];
+        }
+    }
+    for (int k = 0; k < 3; ++k) {
+        pOutA[k] = static_cast<float>(static_cast<double>(tSum[k]) / pNumpx);
+    }
+}
+
+} // namespace
+
+void DefogKernels::atmosphericLight(const cv::Mat &pSource, const cv::Mat &pDark, float pOutA[])
+{
+    const int tRows = pDark.rows;
+    const int tCols = pDark.cols;
+    const size_t tImgSize = static_cast<size_t>(tRows) * tCols;
+    const size_t tNumpx = std::max<size_t>(tImgSize / 1000, 1);
+    pOutA[0] = pOutA[1] = pOutA[2] = 0.0f;
+    if (tImgSize == 0) return;
+    if (pDark.depth() == CV_8U) {
+        atmosphericLight8u(pSource, pDark, tNumpx, pOutA);
+        return;
+    }
+
+    // Pass 1: upper 16 bits of the keys
+    std::vector<uint32_t> tHistogram(1 << 16, 0);
+    for (int r = 0; r < tRows; ++r) {
+        const float* tDarkRow = pDark.ptr<float>(r);
+        for (int c = 0; c < tCols; ++c) {
+            ++tHistogram[orderedKey(tDarkRow[c]) >> 16];
+        }
+    }
+    size_t tAboveHigh = 0;
+    const uint32_t tHigh = static_cast<uint32_t>(selectBin(tHistogram, tNumpx, tAboveHigh));
+
+    // Pass 2: lower 16 bits of the keys in that bucket, giving the exact threshold key
+    std::fill(tHistogram.begin(), tHistogram.end(), 0);
+    for (int r = 0; r < tRows; ++r) {
+        const float* tDarkRow = pDark.ptr<float>(r);
+        for (int c = 0; c < tCols; ++c) {
+            uint32_t tKey = orderedKey(tDarkRow[c]);
+            if ((tKey >> 16) == tHigh) {
+                ++tHistogram[tKey & 0xFFFFu];
+            }
+        }
+    }
+    size_t tAboveLow = 0;
+    const uint32_t tThreshold = (tHigh << 16) | static_cast<uint32_t>(selectBin(tHistogram, tNumpx - tAboveHigh, tAboveLow));
+    size_t tTies = tNumpx - tAboveHigh - tAboveLow; // Pixels equal to the threshold that are still needed
+
+    // Pass 3, backwards, so the ties with the highest indices are the ones kept
+    std::vector<std::pair<uint32_t, size_t>> tSelected;
+    tSelected.reserve(tNumpx);
+    for (int r = tRows - 1; r >= 0; --r) {
+        const float* tDarkRow = pDark.ptr<float>(r);
+        for (int c = tCols - 1; c >= 0; --c) {
+            uint32_t tKey = orderedKey(tDarkRow[c]);
+            if (tKey > tThreshold) {
+                tSelected.emplace_back(tKey, static_cast<size_t>(r) * tCols + c);
+            } else if (tKey == tThreshold && tTies > 0) {
+                tSelected.emplace_back(tKey, static_cast<size_t>(r) * tCols + c);
+                --tTies;
+            }
+        }
+    }
+
+    // Sum in ascending value, then index, order, like the argsort this replaces
+    std::sort(tSelected.begin(), tSelected.end());
+    for (const std::pair<uint32_t, size_t>& tPixel : tSelected) {
+        const cv::Vec3f& tColor = pSource.at<cv::Vec3f>(static_cast<int>(tPixel.second / tCols), static_cast<int>(tPixel.second % tCols));
+        pOutA[0] += tColor[0];
+        pOutA[1] += tColor[1];
+        pOutA[2] += tColor[2];
+    }
+    pOutA[0] /= tNumpx;
+    pOutA[1] /= tNumpx;
+    pOutA[2] /= tNumpx;
+}
+
+void DefogKernels::darkChannel(const cv::Mat &pSource, int pSize, cv::Mat &pDark, const float pDivisor[])
+{
+    if (pSize < 1) {
+        std::cerr << "Invalid dark channel window: " << pSize << std::endl;
+        return;
+    }
+    if (pSource.type() == CV_32FC3) {
+        darkChannelOf<float>(pSource, pSize, pDark, pDivisor);
+    } else if (pSource.type() == CV_8UC3) {
+        // The tables are built once per image, not once per row
+        uchar tLut[3][256];
+        if (pDivisor) {
+            divisionTables(pDivisor, tLut);
+        }
+        darkChannelOf<uchar>(pSource, pSize, pDark, pDivisor ? static_cast<const uchar (*)[256]>(tLut) : nullptr);
+    } else {
+        std::cerr << "Unsupported image type for the dark channel: " << pSource.type() << std::endl;
+    }
+}
+
+void DefogKernels::guidedFilter(const cv::Mat &pGuide, const cv::Mat &pInput, int pSize, float pEps, int pSubsample, cv::Mat &pOutput)
+{
+    cv::Mat tGuide = pGuide;
+    cv::Mat tInput = pInput;
+    int tSize = pSize;
+    if (pSubsample > 1) {
+        cv::Size tSmall(std::max(1, pGuide.cols / pSubsample), std::max(1, pGuide.rows / pSubsample));
+        cv::resize(pGuide, tGuide, tSmall, 0, 0, cv::INTER_AREA);
+        cv::resize(pInput, tInput, tSmall, 0, 0, cv::INTER_AREA);
+        tSize = std::max(1, cvRound(static_cast<double>(pSize) / pSubsample));
+    }
+
+    const cv::Size tWindow(tSize, tSize);
+    cv::Mat tMeanI, tMeanT, tMeanIT, tMeanII, tMeanA, tMeanB;
+    cv::boxFilter(tGuide, tMeanI, CV_32F, tWindow);
+    cv::boxFilter(tInput, tMeanT, CV_32F, tWindow);
+    cv::boxFilter(tGuide.mul(tInput), tMeanIT, CV_32F, tWindow);
+    cv::Mat tCovIT = tMeanIT - tMeanI.mul(tMeanT);
+
+    cv::boxFilter(tGuide.mul(tGuide), tMeanII, CV_32F, tWindow);
+    cv::Mat tVarI = tMeanII - tMeanI.mul(tMeanI);
+
+    cv::Mat a = tCovIT / (tVarI + pEps);
+    cv::Mat b = tMeanT - a.mul(tMeanI);
+    cv::boxFilter(a, tMeanA, CV_32F, tWindow);
+    cv::boxFilter(b, tMeanB, CV_32F, tWindow);
+
+    // Only the smooth coefficients go back to full resolution; the guide keeps its edges
+    if (pSubsample > 1) {
+        cv::resize(tMeanA, tMeanA, pGuide.size(), 0, 0, cv::INTER_LINEAR);
+        cv::resize(tMeanB, tMeanB, pGuide.size(), 0, 0, cv::INTER_LINEAR);
+    }
+    pOutput = tMeanA.mul(pGuide) + tMeanB;
+}
+
+void DefogKernels::recover(const cv::Mat &pSource, const cv::Mat &pTransmission, const float pA[], float pTx, cv::Mat &pOutput)
+{
+    if (pSource.type() != CV_8UC3 || pTransmission.type() != CV_8UC1) {
+        std::cerr << "Unsupported image types for the fixed-point recovery: " << pSource.type()
+                  << ", " << pTransmission.type() << std::endl;
+        return;
+    }
+
+    // J = I / t + A (1 - 1 / t) in Q12: one reciprocal and one offset per channel for each of the 256 levels of t
+    const int tShift = 12;
+    const float tOne = static_cast<float>(1 << tShift);
+    const float tFloor = std::max(pTx, 1.0f / 255);
+    int32_t tReciprocal[256];
+    int32_t tOffset[3][256];
+    for (int q = 0; q < 256; ++q) {
+        float tInverse = 1.0f / std::max(q / 255.0f, tFloor);
+        tReciprocal[q] = cvRound(tInverse * tOne);
+        for (int k = 0; k < 3; ++k) {
+            tOffset[k][q] = cvRound(pA[k] * (1.0f - tInverse) * tOne) + (1 << (tShift - 1)); // Rounding included
+        }
+    }
+
+    pOutput.create(pSource.rows, pSource.cols, CV_8UC3);
+    for (int r = 0; r < pSource.rows; ++r) {
+        const uchar* tSourceRow = pSource.ptr<uchar>(r);
+        const uchar* tTransmissionRow = pTransmission.ptr<uchar>(r);
+        uchar* tOutputRow = pOutput.ptr<uchar>(r);
+        for (int c = 0; c < pSource.cols; ++c) {
+            const int q = tTransmissionRow[c];
+            for (int k = 0; k < 3; ++k) {
+                int32_t tValue = (tSourceRow[3 * c + k] * tReciprocal[q] + tOffset[k][q]) >> tShift;
+                tOutputRow[3 * c + k] = static_cast<uchar>(std::min(std::max(tValue, 0), 255));
+            }
+        }
+    }
+}
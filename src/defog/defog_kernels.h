@@ -0,0 +1,75 @@
+#ifndef DEFOGKERNELS_H
+#define DEFOGKERNELS_H
+
+#include <opencv2/core.hpp>
+
+/*!
+ * \brief Image kernels of the dark channel prior defogging.
+ * \details Stateless building blocks used by the Defogger, kept apart from the stage so they can be
+ * benchmarked and compared with the reference OpenCV formulation on their own. All functions are
+ * thread-safe; scratch memory is local to each call.
+ */
+class DefogKernels {
+public:
+    /*!
+     * \brief Estimates the global atmospheric light A.
+     * \param pSource The CV_32FC3 or CV_8UC3 image.
+     * \param pDark Its CV_32FC1 or CV_8UC1 dark channel.
+     * \param pOutA Receives the mean color of the pixels with the brightest 0.1% dark channel values (at least one pixel),
+     * in the scale of pSource.
+     * \details The brightest pixels are found by a radix select over the bit patterns of the dark channel
+     * values: a histogram of the upper 16 bits locates the bucket holding the k-th largest value, a
+     * histogram of the lower 16 bits within that bucket gives its exact value, and a last pass gathers
+     * the k pixels. The cost is three linear passes, with no index vector and no sort of the whole image.
+     * Ties at the threshold keep the pixels with the highest indices, and the colors are summed in
+     * ascending dark value, then index, order; this is the result of an index-stable ascending argsort
+     * of the dark channel, bit for bit. An 8-bit dark channel needs a single 256-bin histogram, and its sums are exact.
+     */
+    static void atmosphericLight(const cv::Mat& pSource, const cv::Mat& pDark, float pOutA[3]);
+
+    /*!
+     * \brief Computes the dark channel of an image, the minimum over its channels eroded by a square window.
+     * \param pSource The interleaved CV_32FC3 or CV_8UC3 image.
+     * \param pSize Side of the window.
+     * \param pDark Receives the CV_32FC1 or CV_8UC1 dark channel, the depth of pSource.
+     * \param pDivisor Optional divisors of the three channels, applied before the minimum. The transmission estimate
+     * takes the dark channel of the image divided by A this way, without a scaled copy. For CV_8UC3 the quotients
+     * are scaled by 255 and saturated, through one lookup table per channel, so 255 stands for a ratio of 1 or more; there a divisor below 1 is taken as 1.
+     * \details The channel minimum is taken straight from the interleaved pixels and feeds the erosion, which
+     * runs the van Herk/Gil-Werman running minimum along the rows, then down the columns. Both passes split
+     * the line into blocks of pSize and combine a forward and a backward running minimum of the blocks,
+     * so each pixel costs three comparisons whatever the window size. The column pass and the channel
+     * minimum process whole rows with the OpenCV universal intrinsics. The window and borders match
+     * cv::erode with a centered rectangle, and the result equals the split, min and erode sequence exactly.
+     */
+    static void darkChannel(const cv::Mat& pSource, int pSize, cv::Mat& pDark, const float pDivisor[3] = nullptr);
+
+    /*!
+     * \brief Smooths an image with the guided filter of He et al., optionally in its fast, subsampled form.
+     * \param pGuide The CV_32FC1 guide image.
+     * \param pInput The CV_32FC1 image to be filtered, of the size of pGuide.
+     * \param pSize Side of the box window at full resolution.
+     * \param pEps Regularization of the linear coefficients.
+     * \param pSubsample Subsampling factor s of the fast guided filter; 1 runs the filter at full resolution.
+     * \param pOutput Receives the CV_32FC1 filtered image.
+     * \details With s above 1, the guide and the input are shrunk s times, the box means and the a and b coefficients
+     * are computed on them with a window of pSize / s, and only the smoothed coefficients are enlarged back and
+     * applied to the full-resolution guide. The six box filters and their temporaries then cost about 1/s² of the
+     * full-resolution ones. Since the coefficients are smooth by construction, the edges still follow the full guide.
+     */
+    static void guidedFilter(const cv::Mat& pGuide, const cv::Mat& pInput, int pSize, float pEps, int pSubsample, cv::Mat& pOutput);
+
+    /*!
+     * \brief Recovers the haze-free image of the 8-bit defogging path, J = (I - A) / t + A.
+     * \param pSource The CV_8UC3 hazy image.
+     * \param pTransmission The refined CV_8UC1 transmission, 255 standing for t = 1.
+     * \param pA The atmospheric light in the 0-255 scale.
+     * \param pTx Lower bound of t.
+     * \param pOutput Receives the CV_8UC3 result.
+     * \details Since t only takes 256 values, 1 / t and A (1 - 1 / t) are tabulated per frame in Q12 fixed point, and every
+     * channel of every pixel costs one multiply, one add and a shift, with no division and no float conversion.
+     */
+    static void recover(const cv::Mat& pSource, const cv::Mat& pTransmission, const float pA[3], float pTx, cv::Mat& pOutput);
+};
+
+#endif // DEFOGKERNELS_H
@@ -1,4 +1,8 @@
 #include "defogger.h"
+#include "frame_pool.h"
+#include "defog_kernels.h"
+#include <algorithm>
+#include <opencv2/imgproc.hpp>
 
 Defogger::Defogger(EventDispatcher& dispatcher)
     : IProcessor(dispatcher)
@@ -11,24 +15,24 @@ Defogger::~Defogger() {
 
 void Defogger::processEvents() {
     while (running.load()) {
-        std::unique_lock<std::mutex> lock(queueMutex);
-        queueCondition.wait(lock, [this]() { return !frameQueue.empty() || !running.load(); });
+        uint64_t ticket = 0;
+        std::optional<Event> event = waitForEvent(ticket);
+        if (!event) break; // Exit if not running
 
-        if (!running.load()) break; // Exit if not running
-
-        std::pair<cv::Mat, cv::Mat> frames = frameQueue.front();
-        frameQueue.pop();
-        lock.unlock();
         cv::Mat defoggedFrame;
-
-        // Process the frame for defogging
-        defog(frames.second, defoggedFrame);
-
-        // Post the defogged frame as a new event
-        dispatcher.postEvent(Event(Event::Type::FrameDefoggerReady, std::make_pair(frames.first, defoggedFrame)));
-
-        defoggedFrame.release();
-        frames.second.release();
+        FramePool::instance().attach(defoggedFrame);
+
+        // Process the frame for defogging; in temporal mode the history plans the frames in queue order
+        DefogHistory::Plan tPlan;
+        if (history) {
+            tPlan = planInOrder(ticket, *event);
+        }
+        defogPlanned(event->data.second, defoggedFrame, event->sourceId, history ? &tPlan : nullptr);
+
+        // Forward the event with the defogged frame
+        event->type = Event::Type::FrameDefoggerReady;
+        event->data.second = std::move(defoggedFrame);
+        publishEvent(ticket, std::move(*event));
     }
 }
 
@@ -42,112 +46,208 @@ std::thread Defogger::getThreadInfo()
     return std::thread(&Defogger::processEvents, this);
 }
 
+std::string Defogger::getStageName() const
+{
+    return "defogger";
+}
+
+void Defogger::setFixedPoint(bool enabled)
+{
+    fixedPoint = enabled;
+}
+
+void Defogger::setGuidedSubsample(int factor)
+{
+    guidedSubsample = std::max(1, factor);
+}
+
+void Defogger::setTemporal(bool enabled, uint32_t lightInterval, float lightSmoothing, uint32_t transmissionInterval, int transmissionScale)
+{
+    history.reset(enabled ? new DefogHistory(lightInterval, lightSmoothing, transmissionInterval, transmissionScale) : nullptr);
+}
+
+uint64_t Defogger::lightEstimates() const
+{
+    return lightEstimateCount.load();
+}
+
+uint64_t Defogger::transmissionEstimates() const
+{
+    return transmissionEstimateCount.load();
+}
+
+void Defogger::defogFrame(uint32_t pSourceId, uint64_t pSequenceId, const cv::Mat& pSource, cv::Mat& pOutput) {
+    if (!history) {
+        defog(pSource, pOutput);
+        return;
+    }
+    DefogHistory::Plan tPlan = history->plan(pSourceId, pSequenceId, pSource);
+    defogPlanned(pSource, pOutput, pSourceId, &tPlan);
+}
+
+DefogHistory::Plan Defogger::planInOrder(uint64_t pTicket, const Event& pEvent) {
+    // Workers take their turn by ticket, so the scene gate and the intervals see every frame in order
+    std::unique_lock<std::mutex> tLock(planMutex);
+    planCondition.wait(tLock, [this, pTicket] { return nextPlanTicket == pTicket; });
+    DefogHistory::Plan tPlan = history->plan(pEvent.sourceId, pEvent.sequenceId, pEvent.data.second);
+    ++nextPlanTicket;
+    planCondition.notify_all();
+    return tPlan;
+}
+
 void Defogger::defog(cv::Mat pSource, cv::Mat& pOutput, int pRectSize, double pOmega, double pNumt) {
+    defogPlanned(pSource, pOutput, 0, nullptr, pRectSize, pOmega, pNumt);
+}
+
+void Defogger::defogPlanned(const cv::Mat& pSource, cv::Mat& pOutput, uint32_t pSourceId, const DefogHistory::Plan* pPlan,
+                            int pRectSize, double pOmega, double pNumt) {
+    if (fixedPoint && pSource.type() == CV_8UC3) {
+        defogFixed(pSource, pOutput, pRectSize, pOmega, pNumt, pSourceId, pPlan);
+    } else {
+        defogFloat(pSource, pOutput, pRectSize, pOmega, pNumt, pSourceId, pPlan);
+    }
+}
+
+void Defogger::defogFloat(const cv::Mat& pSource, cv::Mat& pOutput, int pRectSize, double pOmega, double pNumt,
+                          uint32_t pSourceId, const DefogHistory::Plan* pPlan) {
     int originalType = pSource.type();
     cv::Mat tI;
+    FramePool::instance().attach(tI);
     pSource.convertTo(tI, CV_32F);
     tI /= 255;
 
     float tA[3] = { 0 };
-    cv::Mat tDark = darkChannel(tI, pRectSize);
-    atmLight(tI, tDark, tA);
+    if (!pPlan || pPlan->estimateLight || !history->light(pSourceId, tA)) {
+        cv::Mat tDark = darkChannel(tI, pRectSize);
+        atmLight(tI, tDark, tA);
+        lightEstimateCount.fetch_add(1, std::memory_order_relaxed);
+        if (pPlan) {
+            history->blendLight(pSourceId, pPlan->resetLight, tA);
+        }
+    }
+
+    cv::Mat tTransmissionRefined;
+    if (!pPlan || pPlan->estimateTransmission || !history->transmission(pSourceId, pSource.size(), CV_32F, tTransmissionRefined)) {
+        int tScale = pPlan ? history->transmissionScale() : 1;
+        if (tScale > 1) {
+            // Estimated and refined on a smaller frame, then enlarged; the transmission is smooth anyway
+            cv::Size tSmall(std::max(1, pSource.cols / tScale), std::max(1, pSource.rows / tScale));
+            cv::Mat tSmallSource, tSmallI;
+            cv::resize(pSource, tSmallSource, tSmall, 0, 0, cv::INTER_AREA);
+            cv::resize(tI, tSmallI, tSmall, 0, 0, cv::INTER_AREA);
+            cv::Mat tTransmissionEstimated = transmissionEstimate(tSmallI, tA, std::max(1, pRectSize / tScale), pOmega);
+            cv::resize(transmissionRefine(tSmallSource, tTransmissionEstimated, std::max(1, 60 / tScale)),
+                       tTransmissionRefined, pSource.size(), 0, 0, cv::INTER_LINEAR);
+        } else {
+            cv::Mat tTransmissionEstimated = transmissionEstimate(tI, tA, pRectSize, pOmega);
+            tTransmissionRefined = transmissionRefine(pSource, tTransmissionEstimated);
+        }
+        transmissionEstimateCount.fetch_add(1, std::memory_order_relaxed);
+        if (pPlan) {
+            history->storeTransmission(pSourceId, tTransmissionRefined);
+        }
+    }
 
-    cv::Mat tTransmissionEstimated = transmissionEstimate(tI, tA, pRectSize, pOmega);
-    cv::Mat tTransmissionRefined = transmissionRefine(pSource, tTransmissionEstimated);
     cv::Mat tRecovered = recover(tI, tTransmissionRefined, tA, pNumt);
     // Restore the original type and scale
     tRecovered *= 255; // Scale to [0, 255]
     tRecovered.convertTo(pOutput, originalType);
 }
 
-cv::Mat Defogger::darkChannel(cv::Mat pSource, int pSize) {
-    std::vector<cv::Mat> tChanels;
-    cv::split(pSource, tChanels);
+void Defogger::defogFixed(const cv::Mat& pSource, cv::Mat& pOutput, int pRectSize, double pOmega, double pNumt,
+                          uint32_t pSourceId, const DefogHistory::Plan* pPlan) {
+    float tA[3] = { 0 }; // In the 0-255 scale
+    if (!pPlan || pPlan->estimateLight || !history->light(pSourceId, tA)) {
+        cv::Mat tDark;
+        DefogKernels::darkChannel(pSource, pRectSize, tDark);
+        atmLight(pSource, tDark, tA);
+        lightEstimateCount.fetch_add(1, std::memory_order_relaxed);
+        if (pPlan) {
+            // The history keeps A in the 0-1 scale of the float path
+            for (float& tChannel : tA) tChannel /= 255;
+            history->blendLight(pSourceId, pPlan->resetLight, tA);
+        }
+    }
+    if (pPlan) {
+        for (float& tChannel : tA) tChannel *= 255;
+    }
 
-    cv::Mat tMinChannel = (cv::min)((cv::min)(tChanels[0], tChanels[1]), tChanels[2]);
-    cv::Mat tKernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(pSize, pSize));
+    cv::Mat tTransmission;
+    if (!pPlan || pPlan->estimateTransmission || !history->transmission(pSourceId, pSource.size(), CV_8UC1, tTransmission)) {
+        int tScale = pPlan ? history->transmissionScale() : 1;
+        cv::Mat tSource = pSource;
+        int tRectSize = pRectSize;
+        int tGuidedSize = 60;
+        if (tScale > 1) {
+            cv::resize(pSource, tSource, cv::Size(std::max(1, pSource.cols / tScale), std::max(1, pSource.rows / tScale)), 0, 0, cv::INTER_AREA);
+            tRectSize = std::max(1, pRectSize / tScale);
+            tGuidedSize = std::max(1, 60 / tScale);
+        }
+
+        // Dark channel of I / A, 255 standing for a ratio of 1, then t = 1 - omega * dark
+        cv::Mat tDark;
+        DefogKernels::darkChannel(tSource, tRectSize, tDark, tA);
+        cv::Mat tTransmissionEstimated;
+        tDark.convertTo(tTransmissionEstimated, CV_32F, -pOmega / 255.0, 1.0);
+
+        cv::Mat tTransmissionRefined = transmissionRefine(tSource, tTransmissionEstimated, tGuidedSize);
+        tTransmissionRefined.convertTo(tTransmission, CV_8U, 255.0);
+        if (tScale > 1) {
+            cv::resize(tTransmission, tTransmission, pSource.size(), 0, 0, cv::INTER_LINEAR);
+        }
+        transmissionEstimateCount.fetch_add(1, std::memory_order_relaxed);
+        if (pPlan) {
+            history->storeTransmission(pSourceId, tTransmission);
+        }
+    }
+    DefogKernels::recover(pSource, tTransmission, tA, static_cast<float>(pNumt), pOutput);
+}
 
-    cv::Mat tDark(tMinChannel.rows, tMinChannel.cols, CV_32FC1);
-    cv::erode(tMinChannel, tDark, tKernel);
+cv::Mat Defogger::darkChannel(cv::Mat pSource, int pSize) {
+    cv::Mat tDark;
+    DefogKernels::darkChannel(pSource, pSize, tDark);
     return tDark;
 }
 
 void Defogger::atmLight(cv::Mat pSource, cv::Mat pDark, float pOutA[]) {
-    int row = pSource.rows;
-    int col = pSource.cols;
-    int imgSize = row * col;
-
-    std::vector<float> tDarkVector = pDark.reshape(1, imgSize);
-    cv::Mat tSrcVector = pSource.reshape(3, imgSize);
-
-    int tNumpx = int(cv::max(floor(imgSize / 1000), 1.0));
-    std::vector<int> tIndices = argsort(tDarkVector);
-    std::vector<int> tDstIndices(tIndices.begin() + (imgSize - tNumpx), tIndices.end());
-
-    for (int i = 0; i < tNumpx; ++i) {
-        pOutA[0] += tSrcVector.at<cv::Vec3f>(tDstIndices[i], 0)[0];
-        pOutA[1] += tSrcVector.at<cv::Vec3f>(tDstIndices[i], 0)[1];
-        pOutA[2] += tSrcVector.at<cv::Vec3f>(tDstIndices[i], 0)[2];
-    }
-    pOutA[0] /= tNumpx;
-    pOutA[1] /= tNumpx;
-    pOutA[2] /= tNumpx;
+    DefogKernels::atmosphericLight(pSource, pDark, pOutA);
 }
 
 cv::Mat Defogger::transmissionEstimate(cv::Mat pSource, float pOutA[], int pSize, float pOmega) {
-    cv::Mat tImgA = cv::Mat::zeros(pSource.rows, pSource.cols, CV_32FC3);
-
-    std::vector<cv::Mat> tChanels;
-    cv::split(pSource, tChanels);
-    for (int i = 0; i < 3; ++i) {
-        tChanels[i] = tChanels[i] / pOutA[i];
-    }
-
-    merge(tChanels, tImgA);
-    cv::Mat tTransmission = 1 - pOmega * darkChannel(tImgA, pSize);
+    // Dark channel of the image divided by A, without the divided copy
+    cv::Mat tDark;
+    DefogKernels::darkChannel(pSource, pSize, tDark, pOutA);
+    cv::Mat tTransmission = 1 - pOmega * tDark;
     return tTransmission;
 }
 
 cv::Mat Defogger::guidedfilter(cv::Mat pSource, cv::Mat pTransmissionEstimated, int pR, float pEps) {
-    cv::Mat tMeanI, tMeanT, tMeanIT, tMeanII, tMeanA, tMeanB;
-    cv::boxFilter(pSource, tMeanI, CV_32F, cv::Size(pR, pR));
-    cv::boxFilter(pTransmissionEstimated, tMeanT, CV_32F, cv::Size(pR, pR));
-    cv::boxFilter(pSource.mul(pTransmissionEstimated), tMeanIT, CV_32F, cv::Size(pR, pR));
-    cv::Mat tCovIT = tMeanIT - tMeanI.mul(tMeanT);
-
-    cv::boxFilter(pSource.mul(pSource), tMeanII, CV_32F, cv::Size(pR, pR));
-    cv::Mat tVarI = tMeanII - tMeanI.mul(tMeanI);
-
-    cv::Mat a = tCovIT / (tVarI + pEps);
-    cv::Mat b = tMeanT - a.mul(tMeanI);
-    cv::boxFilter(a, tMeanA, CV_32F, cv::Size(pR, pR));
-    cv::boxFilter(b, tMeanB, CV_32F, cv::Size(pR, pR));
-
-    cv::Mat tGuidedFiltered = tMeanA.mul(pSource) + tMeanB;
-
+    cv::Mat tGuidedFiltered;
+    DefogKernels::guidedFilter(pSource, pTransmissionEstimated, pR, pEps, guidedSubsample, tGuidedFiltered);
     return tGuidedFiltered;
 }
 
-cv::Mat Defogger::transmissionRefine(cv::Mat pSource, cv::Mat pTransmissionEstimated) {
+cv::Mat Defogger::transmissionRefine(cv::Mat pSource, cv::Mat pTransmissionEstimated, int pR) {
     cv::Mat tGray;
     cvtColor(pSource, tGray, cv::COLOR_BGR2GRAY);
     tGray.convertTo(tGray, CV_32F);
     tGray /= 255;
 
-    int tR = 60;
     float tEps = 0.0001;
-    cv::Mat tTransmissionRefined = guidedfilter(tGray, pTransmissionEstimated, tR, tEps);
+    cv::Mat tTransmissionRefined = guidedfilter(tGray, pTransmissionEstimated, pR, tEps);
     return tTransmissionRefined;
 }
 
 cv::Mat Defogger::recover(cv::Mat pSource, cv::Mat pTransmissionRefined, float pOutA[], float pTx) {
     cv::Mat tDst = cv::Mat::zeros(pSource.rows, pSource.cols, CV_32FC3);
-    pTransmissionRefined = (cv::max)(pTransmissionRefined, pTx);
+    // Clamp into a new matrix: assigning to pTransmissionRefined would write into the caller's buffer,
+    // which is the transmission shared between frames in temporal mode
+    cv::Mat tT = (cv::max)(pTransmissionRefined, pTx);
 
     std::vector<cv::Mat> tChanels;
     cv::split(pSource, tChanels);
     for (int i = 0; i < 3; ++i) {
-        tChanels[i] = (tChanels[i] - pOutA[i]) / pTransmissionRefined + pOutA[i];
+        tChanels[i] = (tChanels[i] - pOutA[i]) / tT + pOutA[i];
     }
     cv::merge(tChanels, tDst);
     return tDst;
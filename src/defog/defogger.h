@@ -3,10 +3,14 @@
 
 #include <thread>
 #include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <opencv2/core.hpp>
 #include <opencv2/highgui.hpp>
 #include <opencv2/photo.hpp>
 #include "iprocessor.h"
+#include "defog_history.h"
 
 
 /*!
@@ -22,26 +26,56 @@ public:
     Defogger(EventDispatcher& dispatcher);
     ~Defogger();
 
-private:
     /*!
-    * \brief processEvents
-    * \details Handles and processes events. This function overrides the base class implementation to provide specific event handling logic.
-    */
-    void processEvents() override;
+     * \brief Selects the 8-bit fixed-point defogging path.
+     * \param enabled True to defog 8-bit frames without converting them to float, false for the float path.
+     * \details Must be called before start(). The fixed-point path keeps the frame, its dark channels and the
+     * transmission estimate in 8 bits and recovers the image through lookup tables, see DefogKernels::recover.
+     * Only the single-channel guided filter stays in float. Frames that are not CV_8UC3 take the float path.
+     */
+    void setFixedPoint(bool enabled);
 
     /*!
-    * \brief getAccessibleType
-    * \return The type of events that the processor can handle.
-    * \details Overrides the base class method to return the specific event type(s) that this derived class can process.
-    */
-    Event::Type getAccessibleType() override;
+     * \brief Sets the subsampling factor of the guided filter refining the transmission.
+     * \param factor The fast guided filter computes its coefficients on a frame shrunk this many times; 1 runs the
+     * filter at full resolution, as before.
+     * \details Must be called before start(). See DefogKernels::guidedFilter.
+     */
+    void setGuidedSubsample(int factor);
 
     /*!
-    * \brief getThreadInfo
-    * \return A std::thread object representing the worker thread associated with this processor.
-    * \details Overrides the base class method to provide information about the worker thread used by this processor.
-    */
-    std::thread getThreadInfo() override;
+     * \brief Enables the temporal mode, which reuses the atmospheric light and the transmission map across frames.
+     * \param enabled True to keep a DefogHistory per source, false to estimate everything on every frame.
+     * \param lightInterval Number of frames between two estimates of A.
+     * \param lightSmoothing Weight of a new estimate in the exponentially smoothed A, between 0 and 1.
+     * \param transmissionInterval Number of frames between two transmission maps; 1 computes one per frame.
+     * \param transmissionScale The transmission map is computed on the frame shrunk this many times and enlarged.
+     * \details Must be called before start(). Both are refreshed at once on a scene change. Frames in between
+     * only pay for the recovery, and the smoothed A no longer flickers from one frame to the next.
+     */
+    void setTemporal(bool enabled, uint32_t lightInterval, float lightSmoothing, uint32_t transmissionInterval, int transmissionScale);
+
+    /*!
+     * \brief Returns the number of frames the atmospheric light was estimated on.
+     */
+    uint64_t lightEstimates() const;
+
+    /*!
+     * \brief Returns the number of frames a transmission map was computed for.
+     */
+    uint64_t transmissionEstimates() const;
+
+    /*!
+     * \brief Defogs one frame of a stream.
+     * \param pSourceId The source of the frame.
+     * \param pSequenceId Index of the frame within its source.
+     * \param pSource The frame.
+     * \param pOutput Receives the defogged frame.
+     * \details Same as defog with its default parameters, except that the temporal mode, if enabled, takes the
+     * atmospheric light and the transmission map from the history of the source when they are not due. The frames of a
+     * source must be passed in order; the stage's own workers plan in ticket order instead, see planInOrder.
+     */
+    void defogFrame(uint32_t pSourceId, uint64_t pSequenceId, const cv::Mat& pSource, cv::Mat& pOutput);
 
     /*!
     * \brief defog
@@ -55,19 +89,84 @@ private:
     * \details This function uses a dark channel prior to estimate the atmospheric light and transmission map to perform defogging. The parameters
     *          `pRectSize`, `pOmega`, and `pNumt` are used to adjust the size of the window for dark channel estimation, the atmospheric light
     *          parameter, and the transmission map value, respectively. The defogging process aims to enhance the visibility of the image by reducing
-    *          the effects of fog or haze.
+    *          the effects of fog or haze. Public so the benchmarks can run it outside the pipeline.
     * \note The choice of `pRectSize` influences the effectiveness of the defogging. Larger values may produce smoother results but could also
     *       reduce the visibility of fine details. The `pOmega` value controls the estimation of atmospheric light and affects the overall contrast.
     *       Adjust `pNumt` to fine-tune the transmission map estimation for different levels of fog density.
     */
     void defog(cv::Mat pSource, cv::Mat& pOutput, int pRectSize = 15, double pOmega = 0.95, double pNumt = 0.1);
 
+private:
+    /*!
+    * \brief processEvents
+    * \details Handles and processes events. This function overrides the base class implementation to provide specific event handling logic.
+    */
+    void processEvents() override;
+
+    /*!
+    * \brief getAccessibleType
+    * \return The type of events that the processor can handle.
+    * \details Overrides the base class method to return the specific event type(s) that this derived class can process.
+    */
+    Event::Type getAccessibleType() override;
+
+    /*!
+    * \brief getThreadInfo
+    * \return A std::thread object representing the worker thread associated with this processor.
+    * \details Overrides the base class method to provide information about the worker thread used by this processor.
+    */
+    std::thread getThreadInfo() override;
+
+    /*!
+     * \brief Gets the name of this stage.
+     * \return "defogger", the `stage` label of its metrics.
+     */
+    std::string getStageName() const override;
+
+    /*!
+     * \brief planInOrder
+     * \param pTicket The ticket of the frame, from waitForEvent
+     * \param pEvent The frame
+     * \return The plan of the frame, see DefogHistory::plan
+     * \note: Waits until the frames of all earlier tickets are planned, so with several workers the history still
+     * sees the frames in queue order
+     */
+    DefogHistory::Plan planInOrder(uint64_t pTicket, const Event& pEvent);
+
+    /*!
+     * \brief defogPlanned
+     * \param pSource
+     * \param pOutput
+     * \param pSourceId The source of the frame, for the history.
+     * \param pPlan What the frame estimates itself, or nullptr to estimate everything without the history.
+     * \param pRectSize
+     * \param pOmega
+     * \param pNumt
+     * \note: Runs the fixed-point or the float path, see setFixedPoint
+     */
+    void defogPlanned(const cv::Mat& pSource, cv::Mat& pOutput, uint32_t pSourceId, const DefogHistory::Plan* pPlan,
+                      int pRectSize = 15, double pOmega = 0.95, double pNumt = 0.1);
+
+    /*!
+     * \brief defogFloat
+     * \note: The float path of defogPlanned
+     */
+    void defogFloat(const cv::Mat& pSource, cv::Mat& pOutput, int pRectSize, double pOmega, double pNumt,
+                    uint32_t pSourceId, const DefogHistory::Plan* pPlan);
+
+    /*!
+     * \brief defogFixed
+     * \note: The 8-bit fixed-point path of defogPlanned, for CV_8UC3 frames, see setFixedPoint
+     */
+    void defogFixed(const cv::Mat& pSource, cv::Mat& pOutput, int pRectSize, double pOmega, double pNumt,
+                    uint32_t pSourceId, const DefogHistory::Plan* pPlan);
+
     /*!
      * \brief darkChannel
      * \param pSource
      * \param pSize
      * \return
-     * Find a dark channel
+     * Find a dark channel, see DefogKernels::darkChannel
      * \note: The size of the window is a key parameter for the result. The larger the window, the greater the probability of containing dark channels,
      *  the darker the dark channels, and the less obvious the effect of defogging. The general window size is 11-51 Between, that is,
      *  the radius is between 5-25.
@@ -79,7 +178,8 @@ private:
      * \param pSource
      * \param pDark
      * \return
-     * \note: Find the global atmospheric light value A
+     * \note: Find the global atmospheric light value A, the mean color of the pixels with the brightest 0.1% of the
+     * dark channel. They are found by a linear-time selection, see DefogKernels::atmosphericLight.
      */
     void atmLight(cv::Mat pSource, cv::Mat pDark, float pOutA[3]);
 
@@ -92,6 +192,7 @@ private:
      * \return
      * \note: Calculate and calculate the estimated value of transmittance
      * The omega in has obvious meaning, the smaller the value, the less obvious the defogging effect
+     * The dark channel of the image divided by A is taken in one pass, see DefogKernels::darkChannel
      */
     cv::Mat transmissionEstimate(cv::Mat pSource, float pOutA[3], int pSize, float pOmega);
 
@@ -102,7 +203,7 @@ private:
      * \param pR
      * \param pEps
      * \return
-     * \note:Guided filtering
+     * \note:Guided filtering, subsampled setGuidedSubsample times, see DefogKernels::guidedFilter
      */
     cv::Mat guidedfilter(cv::Mat pSource, cv::Mat pTransmissionEstimated, int pR, float pEps);
 
@@ -110,10 +211,11 @@ private:
      * \brief transmissionRefine
      * \param pSource
      * \param pTransmissionEsticv::Mate
+     * \param pR Side of the guided filter window, smaller when the frame was shrunk
      * \return
      * \note:Calculation of transmittance by guided filtering
      */
-    cv::Mat transmissionRefine(cv::Mat pSource, cv::Mat pTransmissionEstimated);
+    cv::Mat transmissionRefine(cv::Mat pSource, cv::Mat pTransmissionEstimated, int pR = 60);
 
     /*!
      * \brief recover
@@ -127,27 +229,14 @@ private:
     cv::Mat recover(cv::Mat pSource, cv::Mat pTransmissionRefined, float pOutA[3], float pTx);
 
 private:
-     /*!
-     * \brief Returns the indices that would sort a given vector in ascending order.
-     * \param pArray A vector of values that needs to be sorted. This vector's elements are used to determine the sorting order.
-     * \return A vector of indices representing the order in which the elements of `pArray` would be sorted.
-     * \details This template function generates a vector of indices that, when used to access the elements of `pArray`, will return the elements in ascending order. It is useful for obtaining the order of elements without modifying the original vector.
-     * \tparam T The type of elements in the input vector. The function works with any data type that supports comparison operators.
-     */
-    template<typename T>
-    std::vector<int> argsort(const std::vector<T>& pArray)
-    {
-        const int tArrayLen(pArray.size());
-        std::vector<int> tArrayIndex(tArrayLen, 0);
-        for (int i = 0; i < tArrayLen; ++i)
-            tArrayIndex[i] = i;
-
-        sort(tArrayIndex.begin(), tArrayIndex.end(), [&pArray](int tPos1, int tPos2) {
-            return (pArray[tPos1] < pArray[tPos2]);
-        });
-
-        return tArrayIndex;
-    }
+    bool fixedPoint = false;                                ///< Whether 8-bit frames take the fixed-point path.
+    int guidedSubsample = 1;                                ///< Subsampling factor of the guided filter.
+    std::unique_ptr<DefogHistory> history;                  ///< Temporal state, null unless the temporal mode is enabled.
+    std::mutex planMutex;                                   ///< Guards nextPlanTicket and serializes the plans.
+    std::condition_variable planCondition;                  ///< Wakes the workers waiting for their turn to plan.
+    uint64_t nextPlanTicket = 0;                            ///< Ticket of the next frame to plan. Guarded by planMutex.
+    std::atomic<uint64_t> lightEstimateCount{0};            ///< Frames the atmospheric light was estimated on.
+    std::atomic<uint64_t> transmissionEstimateCount{0};     ///< Frames a transmission map was computed for.
 };
 
 #endif // DEFOGGER_H
@@ -0,0 +1,108 @@
+#include "box_tracker.h"
+#include <algorithm>
+
+namespace {
+
+// IoU of two boxes given by center and size
+float centeredIou(float ax, float ay, float aw, float ah, float bx, float by, float bw, float bh) {
+    float interWidth = std::min(ax + aw * 0.5f, bx + bw * 0.5f) - std::max(ax - aw * 0.5f, bx - bw * 0.5f);
+    float interHeight = std::min(ay + ah * 0.5f, by + bh * 0.5f) - std::max(ay - ah * 0.5f, by - bh * 0.5f);
+    if (interWidth <= 0.0f || interHeight <= 0.0f) {
+        return 0.0f;
+    }
+    float inter = interWidth * interHeight;
+    return inter / (aw * ah + bw * bh - inter);
+}
+
+} // namespace
+
+BoxTracker::BoxTracker(float iouThreshold, float velocityGain, uint32_t maxMissed)
+    : iouThreshold(iouThreshold)
+    , velocityGain(velocityGain)
+    , maxMissed(maxMissed)
+{
+}
+
+void BoxTracker::update(uint32_t sourceId, uint64_t frameIndex, const DetectionList &detections)
+{
+    std::vector<Track>& sourceTracks = tracks[sourceId];
+
+    // Score every same-class pair of predicted track and detection
+    matches.clear();
+    for (size_t t = 0; t < sourceTracks.size(); ++t) {
+        const Track& track = sourceTracks[t];
+        float elapsed = static_cast<float>(static_cast<int64_t>(frameIndex - track.frameIndex));
+        float predictedX = track.centerX + track.velocityX * elapsed;
+        float predictedY = track.centerY + track.velocityY * elapsed;
+        for (size_t d = 0; d < detections.size(); ++d) {
+            if (detections.classId[d] != track.classId) {
+                continue;
+            }
+            float iou = centeredIou(predictedX, predictedY, track.width, track.height,
+                                    detections.x[d] + detections.width[d] * 0.5f, detections.y[d] + detections.height[d] * 0.5f,
+                                    detections.width[d], detections.height[d]);
+            if (iou >= iouThreshold) {
+                matches.push_back({ iou, static_cast<uint32_t>(t), static_cast<uint32_t>(d) });
+            }
+        }
+    }
+
+    // Greedy association, best overlap first
+    std::sort(matches.begin(), matches.end(), [](const Match& a, const Match& b) { return a.iou > b.iou; });
+    trackOfDetection.assign(detections.size(), -1);
+    trackMatched.assign(sourceTracks.size(), 0);
+    for (const Match& match : matches) {
+        if (trackOfDetection[match.detection] < 0 && !trackMatched[match.track]) {
+            trackOfDetection[match.detection] = static_cast<int32_t>(match.track);
+            trackMatched[match.track] = 1;
+        }
+    }
+
+    // Every detection becomes a track; matched ones carry over their corrected velocity
+    updatedTracks.clear();
+    for (size_t d = 0; d < detections.size(); ++d) {
+        Track updated { detections.x[d] + detections.width[d] * 0.5f, detections.y[d] + detections.height[d] * 0.5f,
+                        detections.width[d], detections.height[d], 0.0f, 0.0f,
+                        detections.score[d], detections.classId[d], frameIndex, 0 };
+        if (trackOfDetection[d] >= 0) {
+            const Track& previous = sourceTracks[trackOfDetection[d]];
+            float elapsed = static_cast<float>(std::max<uint64_t>(frameIndex - previous.frameIndex, 1));
+            float errorX = updated.centerX - (previous.centerX + previous.velocityX * elapsed);
+            float errorY = updated.centerY - (previous.centerY + previous.velocityY * elapsed);
+            updated.velocityX = previous.velocityX + velocityGain * errorX / elapsed;
+            updated.velocityY = previous.velocityY + velocityGain * errorY / elapsed;
+        }
+        updatedTracks.push_back(updated);
+    }
+
+    // Unmatched tracks coast from their last detection until they missed too many
+    for (size_t t = 0; t < sourceTracks.size(); ++t) {
+        if (!trackMatched[t] && sourceTracks[t].missed < maxMissed) {
+            updatedTracks.push_back(sourceTracks[t]);
+            ++updatedTracks.back().missed;
+        }
+    }
+    sourceTracks.swap(updatedTracks);
+}
+
+void BoxTracker::predict(uint32_t sourceId, uint64_t frameIndex, DetectionList &detections) const
+{
+    detections.clear();
+    detections.origin = DetectionList::Origin::Tracked;
+
+    auto it = tracks.find(sourceId);
+    if (it == tracks.end()) {
+        return;
+    }
+
+    for (const Track& track : it->second) {
+        if (detections.full()) {
+            break;
+        }
+        float elapsed = static_cast<float>(static_cast<int64_t>(frameIndex - track.frameIndex));
+        float centerX = track.centerX + track.velocityX * elapsed;
+        float centerY = track.centerY + track.velocityY * elapsed;
+        detections.push(centerX - track.width * 0.5f, centerY - track.height * 0.5f,
+                        track.width, track.height, track.score, track.classId);
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef BOXTRACKER_H
+#define BOXTRACKER_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "detection_list.h"
+
+/*!
+ * \brief Propagates detected boxes to the frames the network skips.
+ * \details Keeps one track per detected box and per source. When a frame is detected, its boxes are
+ * associated with the tracks greedily by IoU, within the same class. A matched track snaps to the detected
+ * box and corrects its velocity with the distance between where it predicted the box and where it was
+ * detected (an alpha-beta velocity update; the position is not filtered). Unmatched boxes start new tracks
+ * at rest, so a new object stays still until its second detection. An unmatched track coasts along its
+ * velocity for up to maxMissed detected frames, so one missed detection does not lose the object for a
+ * whole stride; after that it is dropped and the detector stays the authority on what exists.
+ * On a skipped frame every track is moved along its velocity. Time is counted in frames
+ * (Event::sequenceId), which keeps the motion model right when the video is not read in real time.
+ * Not thread-safe; the caller must feed the frames of a source in order.
+ */
+class BoxTracker {
+public:
+    /*!
+     * \brief Constructs a BoxTracker.
+     * \param iouThreshold Minimum IoU between a predicted and a detected box for them to be associated.
+     * \param velocityGain Fraction of the prediction error, per frame, added to the velocity of a track.
+     * \param maxMissed Number of detected frames in a row a track may miss before it is dropped.
+     */
+    explicit BoxTracker(float iouThreshold = 0.3f, float velocityGain = 0.5f, uint32_t maxMissed = 2);
+
+    /*!
+     * \brief Replaces the tracks of a source with the boxes detected on one of its frames, plus the coasting tracks.
+     * \param sourceId The source of the frame.
+     * \param frameIndex Sequence number of the frame within its source.
+     * \param detections The boxes detected on the frame.
+     */
+    void update(uint32_t sourceId, uint64_t frameIndex, const DetectionList& detections);
+
+    /*!
+     * \brief Predicts the boxes of a source on a frame the network skipped.
+     * \param sourceId The source of the frame.
+     * \param frameIndex Sequence number of the frame within its source.
+     * \param detections Receives the predicted boxes; cleared first, origin set to Tracked.
+     */
+    void predict(uint32_t sourceId, uint64_t frameIndex, DetectionList& detections) const;
+
+private:
+    /*!
+     * \brief State of one tracked box.
+     */
+    struct Track {
+        float centerX;      ///< Horizontal center at frameIndex.
+        float centerY;      ///< Vertical center at frameIndex.
+        float width;        ///< Width of the box.
+        float height;       ///< Height of the box.
+        float velocityX;    ///< Horizontal motion of the center, in pixels per frame.
+        float velocityY;    ///< Vertical motion of the center, in pixels per frame.
+        float score;        ///< Confidence of the last detection.
+        int32_t classId;    ///< Class of the box.
+        uint64_t frameIndex; ///< Frame of the last detection.
+        uint32_t missed;    ///< Detected frames missed in a row since the last detection.
+    };
+
+    /*!
+     * \brief A possible association between a track and a detection.
+     */
+    struct Match {
+        float iou;          ///< IoU between the predicted and the detected box.
+        uint32_t track;     ///< Index of the track.
+        uint32_t detection; ///< Index of the detection.
+    };
+
+    float iouThreshold;                                         ///< Minimum IoU of an association.
+    float velocityGain;                                         ///< Velocity correction per frame of prediction error.
+    uint32_t maxMissed;                                         ///< Missed detected frames before a track is dropped.
+    std::unordered_map<uint32_t, std::vector<Track>> tracks;   ///< Tracks by source id.
+    std::vector<Track> updatedTracks;                           ///< Scratch for the tracks built by update().
+    std::vector<Match> matches;                                 ///< Scratch for the candidate associations.
+    std::vector<int32_t> trackOfDetection;                      ///< Scratch: matched track of each detection, or -1.
+    std::vector<uint8_t> trackMatched;                          ///< Scratch: non-zero once a track is matched.
+};
+
+#endif // BOXTRACKER_H
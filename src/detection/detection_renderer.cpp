@@ -0,0 +1,114 @@
+#include "detection_renderer.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+DetectionRenderer::DetectionRenderer(const std::string &classesPath, const std::string &colorsPath, EventDispatcher &dispatcher, bool memoryMapped)
+    : IProcessor(dispatcher)
+{
+    parseClassName(classesPath, memoryMapped);
+    parseRgbColors(colorsPath);
+}
+
+DetectionRenderer::~DetectionRenderer() {
+    stop();
+}
+
+void DetectionRenderer::processEvents() {
+    while (running.load()) {
+        uint64_t ticket = 0;
+        std::optional<Event> event = waitForEvent(ticket);
+        if (!event) break; // Exit if not running
+
+        cv::Mat& image = event->data.second;
+        const DetectionList& detections = event->detections;
+        for (size_t i = 0; i < detections.size(); ++i) {
+            size_t objectClass = static_cast<size_t>(detections.classId[i]);
+            cv::Scalar color = objectClass < colors.size() ? colors[objectClass] : cv::Scalar(0, 255, 0);
+            cv::Rect box((int)detections.x[i], (int)detections.y[i], (int)detections.width[i], (int)detections.height[i]);
+            cv::rectangle(image, box, color, 2);
+
+            // Add class name text
+            std::string label = objectClass < classes.size() ? classes[objectClass] : std::to_string(objectClass);
+            int baseLine;
+            cv::Size labelSize = cv::getTextSize(label, cv::FONT_HERSHEY_SIMPLEX, 0.5, 1, &baseLine);
+            int top = std::max(box.y, labelSize.height);
+            cv::putText(image, label, cv::Point(box.x, top), cv::FONT_HERSHEY_SIMPLEX, 0.75, color, 2);
+        }
+
+        event->type = Event::Type::FrameDetectionReady;
+        publishEvent(ticket, std::move(*event));
+    }
+}
+
+Event::Type DetectionRenderer::getAccessibleType()
+{
+    return Event::Type::DetectionResultsReady;
+}
+
+std::thread DetectionRenderer::getThreadInfo()
+{
+    return std::thread(&DetectionRenderer::processEvents, this);
+}
+
+std::string DetectionRenderer::getStageName() const
+{
+    return "renderer";
+}
+
+void DetectionRenderer::parseRgbColors(const std::string &filePath) {
+    std::ifstream file(filePath);
+    std::string line;
+
+    if (!file.is_open()) {
+        std::cerr << "Error opening file: " << filePath << std::endl;
+        return;
+    }
+
+    while (std::getline(file, line)) {
+        std::istringstream iss(line);
+        std::string token;
+        int r, g, b;
+
+        if (std::getline(iss, token, ',') && std::istringstream(token) >> r &&
+            std::getline(iss, token, ',') && std::istringstream(token) >> g &&
+            std::getline(iss, token) && std::istringstream(token) >> b) {
+            colors.push_back(cv::Scalar(b, g, r));
+        }
+    }
+
+    file.close();
+}
+
+void DetectionRenderer::parseClassName(const std::string &filePath, bool memoryMapped)
+{
+    if (memoryMapped) {
+        MappedFile mapping;
+        if (!mapping.open(filePath)) {
+            return;
+        }
+        // Same lines as std::getline: a trailing newline does not add an empty class
+        const char* begin = mapping.data();
+        const char* end = begin + mapping.size();
+        while (begin != end) {
+            const char* lineEnd = std::find(begin, end, '\n');
+            classes.emplace_back(begin, lineEnd);
+            begin = lineEnd == end ? end : lineEnd + 1;
+        }
+        return;
+    }
+
+    std::ifstream file(filePath);
+    std::string line;
+
+    if (!file.is_open()) {
+        std::cerr << "Error opening file: " << filePath << std::endl;
+        return;
+    }
+
+    while (std::getline(file, line)) {
+        classes.push_back(line);
+    }
+}
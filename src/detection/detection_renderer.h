@@ -0,0 +1,92 @@
+#ifndef DETECTIONRENDERER_H
+#define DETECTIONRENDERER_H
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "iprocessor.h"
+
+/*!
+ * \brief Draws the detections of a frame into its processed image.
+ * \details The DetectionRenderer consumes DetectionResultsReady events, draws a box and a class label
+ * for every entry of Event::detections into `data.second`, and posts the frame as FrameDetectionReady.
+ * It is optional: deployments that only need the detection results skip this stage and its
+ * rasterization cost entirely.
+ */
+class DetectionRenderer : public IProcessor {
+public:
+    /*!
+     * \brief Constructs a DetectionRenderer object.
+     * \param classesPath Path to the file containing class names.
+     * \param colorsPath Path to the file containing RGB colors for visualizations.
+     * \param dispatcher Reference to the EventDispatcher for event handling.
+     * \param memoryMapped True to memory-map the class names file instead of reading it through a stream.
+     */
+    DetectionRenderer(const std::string& classesPath, const std::string& colorsPath, EventDispatcher& dispatcher, bool memoryMapped = false);
+
+    /*!
+     * \brief Destroys the DetectionRenderer object.
+     * \details Stops the worker threads.
+     */
+    ~DetectionRenderer();
+
+protected:
+    /*!
+     * \brief Draws the detections of every queued frame and posts it on.
+     */
+    void processEvents() override;
+
+    /*!
+     * \brief Retrieves the type of events that the DetectionRenderer can handle.
+     * \return Event::Type::DetectionResultsReady.
+     */
+    Event::Type getAccessibleType() override;
+
+    /*!
+     * \brief Retrieves the thread drawing the detections.
+     * \return A std::thread object running processEvents.
+     */
+    std::thread getThreadInfo() override;
+
+    /*!
+     * \brief Gets the name of this stage.
+     * \return "renderer", the `stage` label of its metrics.
+     */
+    std::string getStageName() const override;
+
+private:
+    /*!
+     * \brief Parses RGB colors from a specified file.
+     * \param filePath Path to the file containing RGB color definitions.
+     * \details Reads and parses RGB colors from the given file to be used for
+     * visualizing detection results. The colors are stored in a vector for use
+     * during rendering.
+     */
+    void parseRgbColors(const std::string& filePath);
+
+    /*!
+     * \brief Parses class names from a specified file.
+     * \param filePath Path to the file containing class names.
+     * \param memoryMapped True to split the lines straight out of a mapping of the file.
+     * \details Reads and parses class names from the given file, which will be
+     * used for labeling detected objects in images or video frames.
+     */
+    void parseClassName(const std::string& filePath, bool memoryMapped);
+
+private:
+    /*!
+    * \brief List of class names for object detection.
+    * \details This vector holds the names of the classes the model is trained to detect, indexed by DetectionList::classId.
+    */
+    std::vector<std::string> classes;
+
+    /*!
+    * \brief List of RGB colors for visualization.
+    * \details This vector holds RGB color values used to visualize the different classes in detection results. Colors are assigned to classes for easy differentiation.
+    */
+    std::vector<cv::Scalar> colors;
+};
+
+#endif // DETECTIONRENDERER_H
@@ -0,0 +1,127 @@
+#include "detector_evaluator.h"
+#include "letterbox.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <tuple>
+#include <opencv2/videoio.hpp>
+
+double DetectorEvaluator::Result::speedup() const
+{
+    return candidateMs > 0.0 ? referenceMs / candidateMs : 0.0;
+}
+
+double DetectorEvaluator::Result::recall() const
+{
+    return referenceBoxes > 0 ? static_cast<double>(matchedBoxes) / static_cast<double>(referenceBoxes) : 1.0;
+}
+
+double DetectorEvaluator::Result::precision() const
+{
+    return candidateBoxes > 0 ? static_cast<double>(matchedBoxes) / static_cast<double>(candidateBoxes) : 1.0;
+}
+
+double DetectorEvaluator::Result::meanIou() const
+{
+    return matchedBoxes > 0 ? matchedIouSum / static_cast<double>(matchedBoxes) : 0.0;
+}
+
+DetectorEvaluator::DetectorEvaluator(float nmsThreshold, int inputSize, float matchIou)
+    : inputSize(inputSize)
+    , matchIou(matchIou)
+    , suppressor(nmsThreshold)
+{
+}
+
+DetectorEvaluator::Result DetectorEvaluator::run(const std::string &videoPath, IDetector &reference, IDetector &candidate, uint64_t maxFrames)
+{
+    Result result;
+    cv::VideoCapture capture(videoPath);
+    if (!capture.isOpened()) {
+        std::cerr << "Error opening video file: " << videoPath << std::endl;
+        return result;
+    }
+
+    LetterboxPreprocessor preprocessor(inputSize);
+    std::vector<Detection> referenceBoxes;
+    std::vector<Detection> candidateBoxes;
+    cv::Mat frame;
+    while ((maxFrames == 0 || result.frames < maxFrames) && capture.read(frame)) {
+        preprocessor.allocateBlob(blob, 1);
+        LetterboxTransform transform = preprocessor.apply(frame, blob, 0);
+
+        double referenceMs = detect(reference, transform, referenceBoxes);
+        double candidateMs = detect(candidate, transform, candidateBoxes);
+        if (result.frames > 0) {
+            result.referenceMs += referenceMs;
+            result.candidateMs += candidateMs;
+        }
+        match(referenceBoxes, candidateBoxes, result);
+        ++result.frames;
+    }
+    return result;
+}
+
+void DetectorEvaluator::print(const Result &result, std::ostream &out)
+{
+    uint64_t timedFrames = result.frames > 1 ? result.frames - 1 : 1;
+    out << "Evaluated " << result.frames << " frames\n"
+        << "  Reference: " << result.referenceMs / timedFrames << " ms/frame, " << result.referenceBoxes << " boxes\n"
+        << "  Candidate: " << result.candidateMs / timedFrames << " ms/frame, " << result.candidateBoxes << " boxes\n"
+        << "  Speedup:   " << result.speedup() << "x\n"
+        << "  Agreement: " << result.matchedBoxes << " matched boxes, recall " << result.recall() * 100.0
+        << "%, precision " << result.precision() * 100.0 << "%, mean IoU " << result.meanIou() << std::endl;
+}
+
+double DetectorEvaluator::detect(IDetector &detector, const LetterboxTransform &transform, std::vector<Detection> &boxes)
+{
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    detector.forward(blob);
+    candidates.clear();
+    detector.decode(0, transform, candidates);
+    suppressor.run(candidates, keptIndices);
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    boxes.clear();
+    for (int index : keptIndices) {
+        boxes.push_back(candidates[index]);
+    }
+    return elapsedMs;
+}
+
+void DetectorEvaluator::match(const std::vector<Detection> &referenceBoxes, const std::vector<Detection> &candidateBoxes, Result &result)
+{
+    result.referenceBoxes += referenceBoxes.size();
+    result.candidateBoxes += candidateBoxes.size();
+
+    // Every same-class pair overlapping enough, best overlap first
+    std::vector<std::tuple<float, size_t, size_t>> pairs;
+    for (size_t r = 0; r < referenceBoxes.size(); ++r) {
+        for (size_t c = 0; c < candidateBoxes.size(); ++c) {
+            if (referenceBoxes[r].classId != candidateBoxes[c].classId) {
+                continue;
+            }
+            const cv::Rect2f& a = referenceBoxes[r].box;
+            const cv::Rect2f& b = candidateBoxes[c].box;
+            float inter = (a & b).area();
+            float iou = inter > 0.0f ? inter / (a.area() + b.area() - inter) : 0.0f;
+            if (iou >= matchIou) {
+                pairs.emplace_back(iou, r, c);
+            }
+        }
+    }
+    std::sort(pairs.begin(), pairs.end(), [](const auto& a, const auto& b) { return std::get<0>(a) > std::get<0>(b); });
+
+    std::vector<uint8_t> referenceMatched(referenceBoxes.size(), 0);
+    std::vector<uint8_t> candidateMatched(candidateBoxes.size(), 0);
+    for (const auto& pair : pairs) {
+        size_t r = std::get<1>(pair);
+        size_t c = std::get<2>(pair);
+        if (!referenceMatched[r] && !candidateMatched[c]) {
+            referenceMatched[r] = 1;
+            candidateMatched[c] = 1;
+            ++result.matchedBoxes;
+            result.matchedIouSum += std::get<0>(pair);
+        }
+    }
+}
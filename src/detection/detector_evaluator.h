@@ -0,0 +1,101 @@
+#ifndef DETECTOREVALUATOR_H
+#define DETECTOREVALUATOR_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "idetector.h"
+#include "nms.h"
+
+/*!
+ * \brief Compares a candidate detector, e.g. a quantized model, with a reference one on the same clip.
+ * \details Every frame of the clip is letterboxed once and run through both detectors, one frame per
+ * forward pass, followed by the same suppression as the pipeline. The forward, decoding and suppression
+ * time of each detector is measured separately; the first frame is left out because it includes the
+ * lazy initialization of the networks. The boxes of the candidate are matched with those of the reference
+ * greedily by IoU within the same class, so the agreement reads like the recall and precision of the
+ * candidate taken against the reference at a single IoU threshold.
+ */
+class DetectorEvaluator {
+public:
+    /*!
+     * \brief Outcome of an evaluation.
+     */
+    struct Result {
+        uint64_t frames = 0;            ///< Number of frames run through both detectors.
+        double referenceMs = 0.0;       ///< Time spent in the reference detector, first frame excluded.
+        double candidateMs = 0.0;       ///< Time spent in the candidate detector, first frame excluded.
+        uint64_t referenceBoxes = 0;    ///< Boxes kept for the reference detector.
+        uint64_t candidateBoxes = 0;    ///< Boxes kept for the candidate detector.
+        uint64_t matchedBoxes = 0;      ///< Candidate boxes matched with a reference box.
+        double matchedIouSum = 0.0;     ///< Sum of the IoU of the matched pairs.
+
+        /*!
+         * \brief Returns how many times faster the candidate ran.
+         */
+        double speedup() const;
+
+        /*!
+         * \brief Returns the fraction of the reference boxes the candidate found.
+         */
+        double recall() const;
+
+        /*!
+         * \brief Returns the fraction of the candidate boxes the reference agrees with.
+         */
+        double precision() const;
+
+        /*!
+         * \brief Returns the mean IoU of the matched pairs.
+         */
+        double meanIou() const;
+    };
+
+    /*!
+     * \brief Constructs a DetectorEvaluator.
+     * \param nmsThreshold IoU threshold of the suppression applied to both detectors.
+     * \param inputSize Width and height of the network input of both detectors.
+     * \param matchIou Minimum IoU for a candidate box to match a reference box.
+     */
+    DetectorEvaluator(float nmsThreshold, int inputSize, float matchIou = 0.5f);
+
+    /*!
+     * \brief Runs a clip through both detectors.
+     * \param videoPath The clip.
+     * \param reference The detector taken as the ground truth.
+     * \param candidate The detector being evaluated.
+     * \param maxFrames Number of frames to evaluate; 0 runs the whole clip.
+     * \return The timings and the box agreement; no frames if the clip could not be opened.
+     */
+    Result run(const std::string& videoPath, IDetector& reference, IDetector& candidate, uint64_t maxFrames);
+
+    /*!
+     * \brief Prints a result.
+     * \param result The result to be printed.
+     * \param out The stream to print to.
+     */
+    static void print(const Result& result, std::ostream& out);
+
+private:
+    /*!
+     * \brief Runs one detector on the current blob and keeps its boxes.
+     * \return The elapsed time in milliseconds.
+     */
+    double detect(IDetector& detector, const LetterboxTransform& transform, std::vector<Detection>& boxes);
+
+    /*!
+     * \brief Matches the candidate boxes of a frame with the reference boxes and adds them to the result.
+     */
+    void match(const std::vector<Detection>& referenceBoxes, const std::vector<Detection>& candidateBoxes, Result& result);
+
+private:
+    int inputSize;                          ///< Width and height of the network input.
+    float matchIou;                         ///< Minimum IoU of a match.
+    NonMaxSuppressor suppressor;            ///< Suppression applied to both detectors.
+    cv::Mat blob;                           ///< Input blob of the current frame.
+    std::vector<Detection> candidates;      ///< Scratch for the candidates of a detector.
+    std::vector<int> keptIndices;           ///< Scratch for the suppression.
+};
+
+#endif // DETECTOREVALUATOR_H
@@ -0,0 +1,55 @@
+#ifndef IDETECTOR_H
+#define IDETECTOR_H
+
+#include <vector>
+#include <opencv2/core.hpp>
+#include "letterbox.h"
+#include "nms.h"
+
+/*!
+ * \brief Interface of the object detection backends.
+ * \details A detector runs a batch of letterboxed frames through a model and turns the outputs of each
+ * frame into detection candidates; the suppression of overlapping candidates is left to the caller.
+ * A detector holds the forward state of its model, so each inference worker owns its own instance.
+ */
+class IDetector {
+public:
+    /*!
+     * \brief Inference backends a detector can run on.
+     */
+    enum class Backend {
+        OpenCV,     ///< OpenCV's own CPU implementation of the layers.
+        OpenVINO,   ///< Intel OpenVINO, when OpenCV was built with it.
+        Halide      ///< Halide, when OpenCV was built with it.
+    };
+
+    /*!
+     * \brief Arithmetic precision of the forward pass.
+     */
+    enum class Precision {
+        FP32,       ///< Single precision.
+        FP16,       ///< Half precision, where the backend supports it on the CPU.
+        INT8        ///< 8 bit integers; needs a quantized model, e.g. an INT8 ONNX export.
+    };
+
+    /*!
+     * \brief Destroys the detector.
+     */
+    virtual ~IDetector() = default;
+
+    /*!
+     * \brief Runs a batch through the model.
+     * \param blob The NCHW input blob, see LetterboxPreprocessor.
+     */
+    virtual void forward(const cv::Mat& blob) = 0;
+
+    /*!
+     * \brief Appends the candidates of one frame of the last batch.
+     * \param frame Index of the frame in the blob passed to forward().
+     * \param transform Maps the normalized boxes of the frame to frame pixels.
+     * \param candidates Receives the candidates whose confidence beats the threshold.
+     */
+    virtual void decode(size_t frame, const LetterboxTransform& transform, std::vector<Detection>& candidates) = 0;
+};
+
+#endif // IDETECTOR_H
@@ -1,21 +1,22 @@
 #include "inference_engine.h"
+#include "frame_pool.h"
+#include "nms.h"
+#include "opencv_detector.h"
+#include "letterbox.h"
 #include <opencv2/dnn.hpp>
 #include <opencv2/opencv.hpp>
+#include <algorithm>
 #include <iostream>
 
 InferenceEngine::InferenceEngine(const std::string& cfgPath, const std::string& weightsPath,
-                                 const std::string& classesPath, const std::string& colorsPath, float confidenceThreshold, EventDispatcher& dispatcher)
+                                 float confidenceThreshold, float nmsThreshold, EventDispatcher& dispatcher)
     : IProcessor(dispatcher)
     , cfgPath(cfgPath)
     , weightsPath(weightsPath)
-    , classesPath(classesPath)
-    , colorsPath(colorsPath)
     , confidenceThreshold(confidenceThreshold)
+    , nmsThreshold(nmsThreshold)
 {
 
-    parseClassName(classesPath.c_str());
-    parseRgbColors(colorsPath.c_str());
-
 }
 
 InferenceEngine::~InferenceEngine() {
@@ -23,108 +24,203 @@ InferenceEngine::~InferenceEngine() {
 }
 
 
-void InferenceEngine::processEvents() {
-    cv::dnn::Net net = cv::dnn::readNetFromDarknet(cfgPath, weightsPath);
-    net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
-    net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+void InferenceEngine::setBatching(size_t size, std::chrono::milliseconds timeout)
+{
+    batchSize = std::max<size_t>(size, 1);
+    batchTimeout = timeout;
+}
 
-    while (running.load()) {
-        std::unique_lock<std::mutex> lock(queueMutex);
-        queueCondition.wait(lock, [this]() { return !frameQueue.empty() || !running.load(); });
-
-        if (!running.load()) break; // Exit if not running
-
-        std::pair<cv::Mat, cv::Mat> frames = frameQueue.front();
-        frameQueue.pop();
-        lock.unlock();
-
-        // Perform inference
-        cv::Mat blob;
-        cv::dnn::blobFromImage(frames.second, blob, 1.0 / 255.0, cv::Size(416, 416), cv::Scalar(), true, false);
-        net.setInput(blob);
-        std::vector<cv::Mat> detections;
-        net.forward(detections, net.getUnconnectedOutLayersNames());
-
-        // Process detections
-        std::vector<cv::Rect> boxes;
-        for (auto& detection : detections) {
-            for (int i = 0; i < detection.rows; ++i) {
-                const int probability_index = 5;
-                const int probability_size = detection.cols - probability_index;
-                float* prob_array_ptr = &detection.at<float>(i, probability_index);
-                size_t objectClass = std::max_element(prob_array_ptr, prob_array_ptr + probability_size) - prob_array_ptr;
-                float confidence = detection.at<float>(i, (int)objectClass + probability_index);
-
-                if (confidence > confidenceThreshold) {
-                    float x_center = detection.at<float>(i, 0) * frames.second.cols;
-                    float y_center = detection.at<float>(i, 1) * frames.second.rows;
-                    float width = detection.at<float>(i, 2) * frames.second.cols;
-                    float height = detection.at<float>(i, 3) * frames.second.rows;
-                    cv::Rect box((int)(x_center - width / 2), (int)(y_center - height / 2), (int)width, (int)height);
-                    boxes.push_back(box);
-                    cv::rectangle(frames.second, box, colors[objectClass], 2);
-
-                    // Add class name text
-                    std::string label = classes[objectClass];
-                    int baseLine;
-                    cv::Size labelSize = cv::getTextSize(label, cv::FONT_HERSHEY_SIMPLEX, 0.5, 1, &baseLine);
-                    int top = std::max(box.y, labelSize.height);
-                    cv::putText(frames.second, label, cv::Point(box.x, top), cv::FONT_HERSHEY_SIMPLEX, 0.75, colors[objectClass], 2);
-                }
-            }
-        }
+void InferenceEngine::setInputSize(int size)
+{
+    inputSize = std::max(32, (size + 16) / 32 * 32);
+}
 
-        // Process detections and post event
-        dispatcher.postEvent(Event(Event::Type::FrameDetectionReady, frames));
-        frames.second.release();
-    }
+void InferenceEngine::setBackend(IDetector::Backend backend, IDetector::Precision precision)
+{
+    this->backend = backend;
+    this->precision = precision;
 }
 
-Event::Type InferenceEngine::getAccessibleType()
+void InferenceEngine::setDetectionStride(size_t stride, bool adaptive)
 {
-    return Event::Type::FrameDefoggerReady;
+    detectionStride = std::max<size_t>(stride, 1);
+    adaptiveStride = adaptive;
 }
 
-std::thread InferenceEngine::getThreadInfo()
+uint64_t InferenceEngine::trackedFrames() const
 {
-    return std::thread(&InferenceEngine::processEvents, this);
+    return trackedFrameCount.load();
 }
 
-void InferenceEngine::parseRgbColors(const std::string &filePath) {
-    std::ifstream file(filePath);
-    std::string line;
+void InferenceEngine::setMotionGate(bool enabled, double changedFraction)
+{
+    motionGate = enabled ? std::make_unique<MotionGate>(changedFraction) : nullptr;
+}
 
-    if (!file.is_open()) {
-        std::cerr << "Error opening file: " << filePath << std::endl;
+uint64_t InferenceEngine::motionSkippedFrames() const
+{
+    return motionSkippedFrameCount.load();
+}
+
+void InferenceEngine::processEvents() {
+    runInference(createDetector());
+}
+
+std::unique_ptr<IDetector> InferenceEngine::createDetector() const
+{
+    return OpenCvDetector::create(cfgPath, weightsPath, backend, precision, confidenceThreshold, inputSize);
+}
+
+void InferenceEngine::runInference(std::unique_ptr<IDetector> detector) {
+    if (!detector) {
+        std::cerr << "Error: Could not load the model." << std::endl;
         return;
     }
 
-    while (std::getline(file, line)) {
-        std::istringstream iss(line);
-        std::string token;
-        int r, g, b;
+    // Per-worker scratch, reused across frames
+    NonMaxSuppressor suppressor(nmsThreshold);
+    std::vector<Detection> candidates;
+    std::vector<int> keptIndices;
+    std::vector<Event> batch;
+    LetterboxPreprocessor preprocessor(inputSize);
+    std::vector<LetterboxTransform> transforms;
+    std::vector<size_t> keyframes;
+    cv::Mat blob;
+    FramePool::instance().attach(blob);
+
+    while (running.load()) {
+        uint64_t firstTicket = 0;
+        if (!waitForEvents(batch, firstTicket, batchSize, batchTimeout)) break; // Exit if not running
+
+        for (Event& event : batch) {
+            event.detections.clear();
+        }
+        if (motionGate) {
+            gateFrames(firstTicket, batch);
+        }
+
+        // Pick the frames the network runs on; the others get their boxes in beforePublish
+        size_t backlog = adaptiveStride ? queuedEventCount() : 0;
+        keyframes.clear();
+        for (size_t frame = 0; frame < batch.size(); ++frame) {
+            Event& event = batch[frame];
+            if (event.detections.origin == DetectionList::Origin::Reused) {
+                continue;
+            } else if (isKeyframe(event, backlog)) {
+                keyframes.push_back(frame);
+            } else {
+                event.detections.origin = DetectionList::Origin::Tracked;
+            }
+        }
+
+        // Letterbox the detected frames into one NCHW blob and run them through the network at once
+        if (!keyframes.empty()) {
+            preprocessor.allocateBlob(blob, static_cast<int>(keyframes.size()));
+            transforms.clear();
+            for (size_t slot = 0; slot < keyframes.size(); ++slot) {
+                transforms.push_back(preprocessor.apply(batch[keyframes[slot]].data.second, blob, static_cast<int>(slot)));
+            }
+
+            detector->forward(blob);
+        }
+
+        size_t slot = 0;
+        for (size_t frame = 0; frame < batch.size(); ++frame) {
+            Event& event = batch[frame];
+
+            if (slot < keyframes.size() && keyframes[slot] == frame) {
+                // Collect the candidates of all output layers
+                candidates.clear();
+                detector->decode(slot, transforms[slot], candidates);
+                ++slot;
+
+                // Keep the best box of every object; drawing is left to the DetectionRenderer
+                suppressor.run(candidates, keptIndices);
+                if (keptIndices.size() > DetectionList::kCapacity) {
+                    // Only the top-k fit the inline list; keep the best scores, whatever their class
+                    std::nth_element(keptIndices.begin(), keptIndices.begin() + DetectionList::kCapacity, keptIndices.end(),
+                                     [&candidates](int a, int b) { return candidates[a].score > candidates[b].score; });
+                    keptIndices.resize(DetectionList::kCapacity);
+                }
+                for (int index : keptIndices) {
+                    const Detection& kept = candidates[index];
+                    event.detections.push(kept.box.x, kept.box.y, kept.box.width, kept.box.height, kept.score, kept.classId);
+                }
+            }
 
-        if (std::getline(iss, token, ',') && std::istringstream(token) >> r &&
-            std::getline(iss, token, ',') && std::istringstream(token) >> g &&
-            std::getline(iss, token) && std::istringstream(token) >> b) {
-            colors.push_back(cv::Scalar(b, g, r));
+            // Post the detections with the frame
+            event.type = Event::Type::DetectionResultsReady;
+            publishEvent(firstTicket + frame, std::move(event));
         }
     }
+}
 
-    file.close();
+void InferenceEngine::gateFrames(uint64_t firstTicket, std::vector<Event> &batch)
+{
+    // Workers take their turn in ticket order, so every frame is compared with the last moving frame before it
+    std::unique_lock<std::mutex> lock(gateMutex);
+    gateCondition.wait(lock, [this, firstTicket] { return nextGateTicket == firstTicket; });
+    for (Event& event : batch) {
+        if (!motionGate->hasMotion(event.sourceId, event.data.second)) {
+            event.detections.origin = DetectionList::Origin::Reused;
+        }
+    }
+    nextGateTicket += batch.size();
+    gateCondition.notify_all();
 }
 
-void InferenceEngine::parseClassName(const std::string &filePath)
+bool InferenceEngine::isKeyframe(const Event &event, size_t backlog) const
 {
-    std::ifstream file(classesPath.c_str());
-    std::string line;
+    if (detectionStride == 1 || (adaptiveStride && backlog < batchSize)) {
+        return true;
+    }
+    return event.sequenceId % detectionStride == 0;
+}
 
-    if (!file.is_open()) {
-        std::cerr << "Error opening file: " << filePath << std::endl;
+void InferenceEngine::beforePublish(Event &event)
+{
+    if (detectionStride == 1 && !motionGate) {
+        return; // Every frame is detected, nothing to track or reuse
+    }
+
+    switch (event.detections.origin) {
+    case DetectionList::Origin::Detected:
+        if (detectionStride > 1) {
+            tracker.update(event.sourceId, event.sequenceId, event.detections);
+        }
+        break;
+    case DetectionList::Origin::Tracked:
+        tracker.predict(event.sourceId, event.sequenceId, event.detections);
+        trackedFrameCount.fetch_add(1, std::memory_order_relaxed);
+        break;
+    case DetectionList::Origin::Reused: {
+        auto it = lastDetections.find(event.sourceId);
+        if (it != lastDetections.end()) {
+            event.detections = it->second;
+            event.detections.origin = DetectionList::Origin::Reused;
+        }
+        motionSkippedFrameCount.fetch_add(1, std::memory_order_relaxed);
         return;
     }
+    }
 
-    while (std::getline(file, line)) {
-        classes.push_back(line);
+    if (motionGate) {
+        lastDetections[event.sourceId] = event.detections;
     }
 }
+
+Event::Type InferenceEngine::getAccessibleType()
+{
+    return Event::Type::FrameDefoggerReady;
+}
+
+std::thread InferenceEngine::getThreadInfo()
+{
+    // Build the detector before the thread starts, so start() returns with the model ready
+    return std::thread(&InferenceEngine::runInference, this, createDetector());
+}
+
+std::string InferenceEngine::getStageName() const
+{
+    return "inference";
+}
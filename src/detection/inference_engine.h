@@ -2,38 +2,45 @@
 #define INFERENCEENGINE_H
 
 #include <opencv2/opencv.hpp>
+#include <opencv2/dnn.hpp>
 #include <thread>
 #include <queue>
 #include <mutex>
 #include <atomic>
 #include <condition_variable>
+#include <memory>
+#include <unordered_map>
 
 #include "iprocessor.h"
+#include "idetector.h"
+#include "box_tracker.h"
+#include "motion_gate.h"
 
 /*!
  * \brief Handles inference tasks for object detection and classification.
  * \details The InferenceEngine class is responsible for running inference algorithms
  * using a pre-trained model to detect and classify objects in images or video frames.
  * It integrates with the IProcessor interface to manage the processing of frames and
- * handle events. This class handles model configuration, weight loading, and class
- * names parsing, as well as maintaining a list of RGB colors for visualizing detections.
+ * handle events. This class handles model configuration and weight loading; the forward pass
+ * and the decoding of the outputs are delegated to an IDetector backend. The detections
+ * of every frame are stored in Event::detections and posted as DetectionResultsReady;
+ * the frame itself is left untouched, drawing is done by the DetectionRenderer.
  */
 class InferenceEngine : public IProcessor {
 public:
     /*!
      * \brief Constructs an InferenceEngine object with specified model and configuration paths.
-     * \param cfgPath Path to the configuration file for the model.
-     * \param weightsPath Path to the weights file for the model.
-     * \param classesPath Path to the file containing class names.
-     * \param colorsPath Path to the file containing RGB colors for visualizations.
+     * \param cfgPath Path to the Darknet configuration file of the model, or empty for an ONNX model.
+     * \param weightsPath Path to the Darknet weights file, or to the ONNX model when cfgPath is empty.
      * \param confidenceThreshold Minimum confidence threshold for detecting objects.
+     * \param nmsThreshold Boxes overlapping a better box of the same class by more than this IoU are suppressed.
      * \param dispatcher Reference to the EventDispatcher for event handling.
      * \details Initializes the InferenceEngine with the given paths and settings.
      * It prepares the necessary resources and configurations required for running
      * inference tasks on images or video frames.
      */
     InferenceEngine(const std::string& cfgPath, const std::string& weightsPath,
-                    const std::string& classesPath, const std::string& colorsPath, float confidenceThreshold, EventDispatcher& dispatcher);
+                    float confidenceThreshold, float nmsThreshold, EventDispatcher& dispatcher);
 
     /*!
      * \brief Destroys the InferenceEngine object and releases resources.
@@ -42,9 +49,66 @@ public:
      */
     ~InferenceEngine();
 
+    /*!
+     * \brief Configures how many frames are run through the network at once.
+     * \param size Maximum number of frames per forward pass; values below 1 are treated as 1.
+     * \param timeout How long a worker waits for the batch to fill once it has a frame.
+     * \details Must be called before start(). The frames of a batch are packed into one NCHW blob, which uses
+     * the CPU GEMM kernels better, at the price of the extra latency of waiting for the batch.
+     */
+    void setBatching(size_t size, std::chrono::milliseconds timeout);
+
+    /*!
+     * \brief Sets the width and height of the network input.
+     * \param size Input size in pixels; rounded to the nearest multiple of 32, at least 32.
+     * \details Must be called before start(). Frames are letterboxed to this square, so smaller sizes
+     * trade accuracy for speed.
+     */
+    void setInputSize(int size);
+
+    /*!
+     * \brief Selects the backend and precision the detectors run with.
+     * \param backend The inference backend; unavailable backends fall back to OpenCV.
+     * \param precision The arithmetic precision; unavailable precisions fall back to FP32.
+     * \details Must be called before start(). The default is the OpenCV backend in FP32.
+     */
+    void setBackend(IDetector::Backend backend, IDetector::Precision precision);
+
+    /*!
+     * \brief Runs the network on only part of the frames and tracks the boxes in between.
+     * \param stride The network runs on frames whose sequence number is a multiple of stride; 1 runs it on every frame.
+     * \param adaptive True to apply the stride only while the input queue backs up, i.e. while a full batch is
+     * already waiting when a worker takes its frames; every frame is detected otherwise.
+     * \details Must be called before start(). The boxes of the skipped frames are propagated by a BoxTracker
+     * and marked DetectionList::Origin::Tracked. A box seen on one detected frame only stays where it was
+     * detected until the next one gives it a velocity; a box missed on one detected frame keeps moving along its
+     * velocity for up to two detected frames before it is dropped.
+     */
+    void setDetectionStride(size_t stride, bool adaptive);
+
+    /*!
+     * \brief Returns the number of frames whose boxes were tracked instead of detected.
+     */
+    uint64_t trackedFrames() const;
+
+    /*!
+     * \brief Skips the network on frames where nothing moved.
+     * \param enabled True to put a MotionGate in front of the network.
+     * \param changedFraction Fraction of the pixels of the downscaled grey frame that must change to count as motion.
+     * \details Must be called before start(). A static frame reuses the boxes of the previous frame of its source,
+     * marked DetectionList::Origin::Reused. The gate sees the frames in queue order whatever the number of workers:
+     * each worker waits for the previous batches to be gated before gating its own.
+     */
+    void setMotionGate(bool enabled, double changedFraction);
+
+    /*!
+     * \brief Returns the number of frames the motion gate skipped.
+     */
+    uint64_t motionSkippedFrames() const;
+
 protected:
     /*!
-     * \brief Processes events related to inference tasks.
+     * \brief Processes events related to inference tasks with a freshly created network.
      * \details This overridden method is responsible for handling and processing
      * events related to object detection and classification. The specific logic
      * will depend on the type of events and the needs of the application.
@@ -64,32 +128,58 @@ protected:
      * \brief Retrieves the thread associated with the InferenceEngine.
      * \return std::thread The thread used for executing inference tasks.
      * \details This overridden method returns the thread object used for performing
-     * inference operations, which can be moved or managed as needed.
+     * inference operations, which can be moved or managed as needed. The network of the
+     * worker is created on the calling thread, so start() returns once every worker's model is loaded.
      */
     std::thread getThreadInfo() override;
 
+    /*!
+     * \brief Gets the name of this stage.
+     * \return "inference", the `stage` label of its metrics.
+     */
+    std::string getStageName() const override;
+
+    /*!
+     * \brief Feeds the tracker in frame order.
+     * \param event The frame about to be posted.
+     * \details Detected frames update the tracks of their source; tracked frames get their boxes predicted and
+     * static frames those of the previous frame of their source.
+     */
+    void beforePublish(Event& event) override;
+
 private:
     /*!
-     * \brief Parses RGB colors from a specified file.
-     * \param filePath Path to the file containing RGB color definitions.
-     * \details Reads and parses RGB colors from the given file to be used for
-     * visualizing detection results. The colors are stored in a vector for use
-     * during rendering.
+     * \brief Creates the detector of one worker, with a network built from the ModelRegistry.
+     * \return The detector, or nullptr if the model could not be loaded.
      */
-    void parseRgbColors(const std::string& filePath);
+    std::unique_ptr<IDetector> createDetector() const;
 
     /*!
-     * \brief Parses class names from a specified file.
-     * \param filePath Path to the file containing class names.
-     * \details Reads and parses class names from the given file, which will be
-     * used for identifying and labeling detected objects in images or video frames.
+     * \brief Body of a worker thread.
+     * \param detector The detector owned by this worker.
      */
-    void parseClassName(const std::string& filePath);
+    void runInference(std::unique_ptr<IDetector> detector);
+
+    /*!
+     * \brief Runs the motion gate on a batch, in ticket order across the workers.
+     * \param firstTicket Ticket of the first frame of the batch.
+     * \param batch The frames; the static ones are marked DetectionList::Origin::Reused.
+     */
+    void gateFrames(uint64_t firstTicket, std::vector<Event>& batch);
+
+    /*!
+     * \brief Decides whether the network runs on a frame.
+     * \param event The frame.
+     * \param backlog Number of frames still queued after the worker took its batch.
+     * \return True to detect the frame, false to track its boxes.
+     */
+    bool isKeyframe(const Event& event, size_t backlog) const;
 
 private:
     /*!
     * \brief Path to the model configuration file.
     * \details This string holds the file path to the configuration file used to set up the model's parameters and structure.
+    * Empty for ONNX models, which hold their structure along with the weights.
     */
     std::string cfgPath;
 
@@ -100,34 +190,93 @@ private:
     std::string weightsPath;
 
     /*!
-    * \brief Path to the file containing class names.
-    * \details This string holds the file path to a file that lists the names of the classes the model can detect.
+    * \brief Minimum confidence threshold for detections.
+    * \details This float value represents the minimum confidence level required for a detection to be considered valid. Detections with a confidence score below this threshold will be ignored.
     */
-    std::string classesPath;
+    float confidenceThreshold;
 
     /*!
-    * \brief Path to the file containing RGB colors.
-    * \details This string holds the file path to a file that specifies the RGB colors used for visualizing different classes.
+    * \brief IoU threshold of the Non-Maximum Suppression.
+    * \details Boxes overlapping a higher scoring box of the same class by more than this IoU are dropped.
     */
-    std::string colorsPath;
+    float nmsThreshold;
 
     /*!
-    * \brief Minimum confidence threshold for detections.
-    * \details This float value represents the minimum confidence level required for a detection to be considered valid. Detections with a confidence score below this threshold will be ignored.
+    * \brief Maximum number of frames per forward pass.
     */
-    float confidenceThreshold;
+    size_t batchSize = 1;
+
+    /*!
+    * \brief How long a worker waits for a batch to fill once it has a frame.
+    */
+    std::chrono::milliseconds batchTimeout{0};
+
+    /*!
+    * \brief Width and height of the network input, a multiple of 32.
+    */
+    int inputSize = 416;
+
+    /*!
+    * \brief Backend the detectors run on.
+    */
+    IDetector::Backend backend = IDetector::Backend::OpenCV;
+
+    /*!
+    * \brief Precision the detectors run in.
+    */
+    IDetector::Precision precision = IDetector::Precision::FP32;
+
+    /*!
+    * \brief The network runs on frames whose sequence number is a multiple of this stride.
+    */
+    size_t detectionStride = 1;
+
+    /*!
+    * \brief Whether the stride only applies while the input queue backs up.
+    */
+    bool adaptiveStride = false;
+
+    /*!
+    * \brief Propagates the boxes to the frames the network skips.
+    * \details Only used from beforePublish, which runs in frame order.
+    */
+    BoxTracker tracker;
+
+    /*!
+    * \brief Number of frames whose boxes were tracked instead of detected.
+    */
+    std::atomic<uint64_t> trackedFrameCount{0};
+
+    /*!
+    * \brief Tells which frames changed enough to run the network; null when motion gating is disabled.
+    */
+    std::unique_ptr<MotionGate> motionGate;
+
+    /*!
+    * \brief Guards nextGateTicket and serializes the motion gate.
+    */
+    std::mutex gateMutex;
+
+    /*!
+    * \brief Wakes the workers waiting for their turn at the motion gate.
+    */
+    std::condition_variable gateCondition;
+
+    /*!
+    * \brief Ticket of the next frame the motion gate must see. Guarded by gateMutex.
+    */
+    uint64_t nextGateTicket = 0;
 
     /*!
-    * \brief List of class names for object detection.
-    * \details This vector holds the names of the classes that the model is trained to detect. It is populated from the file specified by `classesPath`.
+    * \brief Boxes of the last published frame of every source, reused on static frames.
+    * \details Only used from beforePublish, which runs in frame order.
     */
-    std::vector<std::string> classes;
+    std::unordered_map<uint32_t, DetectionList> lastDetections;
 
     /*!
-    * \brief List of RGB colors for visualization.
-    * \details This vector holds RGB color values used to visualize the different classes in detection results. Colors are assigned to classes for easy differentiation.
+    * \brief Number of frames the motion gate skipped.
     */
-    std::vector<cv::Scalar> colors;
+    std::atomic<uint64_t> motionSkippedFrameCount{0};
 };
 
 #endif // INFERENCEENGINE_H
@@ -0,0 +1,95 @@
+#include "letterbox.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <opencv2/imgproc.hpp>
+
+namespace {
+
+const float kPadValue = 0.5f;           // Grey background, as darknet uses
+const float kNormalization = 1.0f / 255.0f;
+
+void fillRow(float* row, int begin, int end) {
+    std::fill(row + begin, row + end, kPadValue);
+}
+
+} // namespace
+
+LetterboxPreprocessor::LetterboxPreprocessor(int inputSize)
+    : inputSize(inputSize)
+{
+
+}
+
+void LetterboxPreprocessor::allocateBlob(cv::Mat &blob, int frameCount) const
+{
+    const int sizes[] = { frameCount, 3, inputSize, inputSize };
+    blob.create(4, sizes, CV_32F);
+}
+
+LetterboxTransform LetterboxPreprocessor::apply(const cv::Mat &frame, cv::Mat &blob, int index)
+{
+    const int size = inputSize;
+    const size_t planeSize = static_cast<size_t>(size) * size;
+    float* red = blob.ptr<float>(index);
+    float* green = red + planeSize;
+    float* blue = green + planeSize;
+
+    if (frame.empty() || frame.type() != CV_8UC3) {
+        std::cerr << "Error: Letterbox expects a non-empty 8-bit BGR frame." << std::endl;
+        std::fill(red, red + 3 * planeSize, kPadValue);
+        return LetterboxTransform::stretch(frame.size());
+    }
+
+    // Fit the frame into the square, keeping its aspect ratio
+    const float scale = std::min(static_cast<float>(size) / frame.cols, static_cast<float>(size) / frame.rows);
+    const int width = std::clamp(static_cast<int>(std::lround(frame.cols * scale)), 1, size);
+    const int height = std::clamp(static_cast<int>(std::lround(frame.rows * scale)), 1, size);
+    const int left = (size - width) / 2;
+    const int top = (size - height) / 2;
+
+    const cv::Mat* source = &frame;
+    if (width != frame.cols || height != frame.rows) {
+        cv::resize(frame, resized, cv::Size(width, height), 0, 0, cv::INTER_LINEAR);
+        source = &resized;
+    }
+
+    // One pass: normalize, BGR -> RGB, HWC -> CHW and padding
+    for (int y = 0; y < size; ++y) {
+        float* redRow = red + static_cast<size_t>(y) * size;
+        float* greenRow = green + static_cast<size_t>(y) * size;
+        float* blueRow = blue + static_cast<size_t>(y) * size;
+        if (y < top || y >= top + height) {
+            fillRow(redRow, 0, size);
+            fillRow(greenRow, 0, size);
+            fillRow(blueRow, 0, size);
+            continue;
+        }
+
+        const uchar* pixel = source->ptr<uchar>(y - top);
+        fillRow(redRow, 0, left);
+        fillRow(greenRow, 0, left);
+        fillRow(blueRow, 0, left);
+        for (int x = 0; x < width; ++x) {
+            blueRow[left + x] = pixel[3 * x] * kNormalization;
+            greenRow[left + x] = pixel[3 * x + 1] * kNormalization;
+            redRow[left + x] = pixel[3 * x + 2] * kNormalization;
+        }
+        fillRow(redRow, left + width, size);
+        fillRow(greenRow, left + width, size);
+        fillRow(blueRow, left + width, size);
+    }
+
+    // Normalized output u maps to (u * size - left) / scale in the frame
+    LetterboxTransform transform;
+    transform.scaleX = size / scale;
+    transform.scaleY = size / scale;
+    transform.offsetX = -left / scale;
+    transform.offsetY = -top / scale;
+    return transform;
+}
+
+int LetterboxPreprocessor::getInputSize() const
+{
+    return inputSize;
+}
@@ -0,0 +1,72 @@
+#ifndef LETTERBOX_H
+#define LETTERBOX_H
+
+#include <opencv2/core.hpp>
+
+/*!
+ * \brief Maps normalized network output coordinates back to frame pixels.
+ * \details A coordinate `u` in [0, 1] of the network input maps to `u * scale + offset` in the frame,
+ * independently on both axes.
+ */
+struct LetterboxTransform {
+    float scaleX = 1.0f;    ///< Frame pixels per normalized unit, horizontally.
+    float scaleY = 1.0f;    ///< Frame pixels per normalized unit, vertically.
+    float offsetX = 0.0f;   ///< Frame x of the left edge of the network input.
+    float offsetY = 0.0f;   ///< Frame y of the top edge of the network input.
+
+    /*!
+     * \brief Returns the transform of a frame stretched over the whole network input.
+     * \param frameSize Size of the frame.
+     */
+    static LetterboxTransform stretch(const cv::Size& frameSize) {
+        LetterboxTransform transform;
+        transform.scaleX = static_cast<float>(frameSize.width);
+        transform.scaleY = static_cast<float>(frameSize.height);
+        return transform;
+    }
+};
+
+/*!
+ * \brief Builds the network input blob from frames, keeping their aspect ratio.
+ * \details Each frame is resized to fit an inputSize x inputSize square and centered on a grey
+ * background, which is how YOLO was trained. The resize writes into a scratch buffer kept between
+ * calls; a single pass then converts it to float, scales it to [0, 1], swaps BGR to RGB, transposes
+ * it to planar CHW and writes the padding, straight into the blob. This replaces the resized,
+ * converted and split intermediates `blobFromImage` allocates for every frame.
+ */
+class LetterboxPreprocessor {
+public:
+    /*!
+     * \brief Constructs a LetterboxPreprocessor.
+     * \param inputSize Width and height of the network input, a multiple of 32.
+     */
+    explicit LetterboxPreprocessor(int inputSize);
+
+    /*!
+     * \brief Allocates the NCHW float blob for a batch.
+     * \param blob The blob to be (re)allocated; kept when it already has the right shape.
+     * \param frameCount Number of frames in the batch.
+     */
+    void allocateBlob(cv::Mat& blob, int frameCount) const;
+
+    /*!
+     * \brief Writes one 8-bit BGR frame into the blob.
+     * \param frame The frame to be written.
+     * \param blob A blob prepared by allocateBlob.
+     * \param index Position of the frame in the batch.
+     * \return The transform mapping the network output of this frame back to its pixels.
+     */
+    LetterboxTransform apply(const cv::Mat& frame, cv::Mat& blob, int index);
+
+    /*!
+     * \brief Gets the size of the network input.
+     * \return Width and height of the network input, in pixels.
+     */
+    int getInputSize() const;
+
+private:
+    int inputSize;          ///< Width and height of the network input.
+    cv::Mat resized;        ///< Scratch buffer holding the resized frame.
+};
+
+#endif // LETTERBOX_H
@@ -0,0 +1,119 @@
+#include "model_registry.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+ModelRegistry &ModelRegistry::instance()
+{
+    static ModelRegistry* registry = new ModelRegistry();
+    return *registry;
+}
+
+void ModelRegistry::setMemoryMapping(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    memoryMapping = enabled;
+}
+
+bool ModelRegistry::preload(const std::string &cfgPath, const std::string &weightsPath)
+{
+    return load(cfgPath, weightsPath) != nullptr;
+}
+
+cv::dnn::Net ModelRegistry::createNet(const std::string &cfgPath, const std::string &weightsPath)
+{
+    std::shared_ptr<const ModelFiles> files = load(cfgPath, weightsPath);
+    if (!files) {
+        return cv::dnn::Net();
+    }
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    cv::dnn::Net net = cfgPath.empty()
+            ? cv::dnn::readNetFromONNX(files->weights.data(), files->weights.size())
+            : cv::dnn::readNetFromDarknet(files->cfg.data(), files->cfg.size(),
+                                          files->weights.data(), files->weights.size());
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    modelStats.netBuildMs += elapsedMs;
+    ++modelStats.netsCreated;
+    return net;
+}
+
+void ModelRegistry::releaseCopies()
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (auto it = models.begin(); it != models.end();) {
+        // A net being parsed right now keeps its files alive through its own shared_ptr
+        if (!it->second->weights.isMapped()) {
+            it = models.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+ModelRegistry::Stats ModelRegistry::stats() const
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    return modelStats;
+}
+
+std::shared_ptr<const ModelRegistry::ModelFiles> ModelRegistry::load(const std::string &cfgPath, const std::string &weightsPath)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::shared_ptr<const ModelFiles>& cached = models[cfgPath + "\n" + weightsPath];
+    if (cached) {
+        return cached;
+    }
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    std::shared_ptr<ModelFiles> files = std::make_shared<ModelFiles>();
+    bool loaded = (cfgPath.empty() || files->cfg.load(cfgPath, memoryMapping)) && files->weights.load(weightsPath, memoryMapping);
+    if (!loaded) {
+        models.erase(cfgPath + "\n" + weightsPath);
+        return nullptr;
+    }
+    modelStats.fileLoadMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    (memoryMapping ? modelStats.mappedBytes : modelStats.cachedBytes) += files->cfg.size() + files->weights.size();
+    cached = files;
+    return cached;
+}
+
+bool ModelRegistry::ModelFile::load(const std::string &path, bool memoryMapped)
+{
+    return memoryMapped ? mapping.open(path) : readFile(path, buffer);
+}
+
+bool ModelRegistry::ModelFile::isMapped() const
+{
+    return mapping.data() != nullptr;
+}
+
+const char *ModelRegistry::ModelFile::data() const
+{
+    return isMapped() ? mapping.data() : buffer.data();
+}
+
+size_t ModelRegistry::ModelFile::size() const
+{
+    return isMapped() ? mapping.size() : buffer.size();
+}
+
+bool ModelRegistry::readFile(const std::string &path, std::vector<char> &content)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        std::cerr << "Error opening file: " << path << std::endl;
+        return false;
+    }
+
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    content.resize(static_cast<size_t>(size));
+    if (size > 0 && !file.read(content.data(), size)) {
+        std::cerr << "Error reading file: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
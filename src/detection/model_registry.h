@@ -0,0 +1,144 @@
+#ifndef MODELREGISTRY_H
+#define MODELREGISTRY_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <opencv2/dnn.hpp>
+#include "mapped_file.h"
+
+/*!
+ * \brief Process-wide cache of the DNN model files.
+ * \details The cfg and weights files of a Darknet model, or the single file of an ONNX model, are read
+ * from disk once and kept in memory until releaseCopies(); every cv::dnn::Net is then parsed from those buffers. OpenCV DNN has no way to share layer blobs between
+ * Net instances and a Net must not run forward passes from two threads at once, so each worker still
+ * owns its Net, with its own parsed copy of the weights, and its forward state; only the file bytes are shared,
+ * and no worker or engine instance touches the disk while the nets are built. The peak memory is therefore one
+ * copy of the weights per net plus the file copy until releaseCopies().
+ * With memory mapping enabled the files are mapped instead of copied: the cache then holds page cache
+ * pages, which are shared with every other process running the same model and can be reclaimed by the
+ * kernel once the nets are built, instead of a private heap copy of the weights.
+ */
+class ModelRegistry {
+public:
+    /*!
+     * \brief Load statistics of the registry.
+     */
+    struct Stats {
+        double fileLoadMs = 0.0;    ///< Time spent reading model files from disk.
+        double netBuildMs = 0.0;    ///< Time spent parsing nets from the cached buffers, summed over all nets.
+        uint64_t netsCreated = 0;   ///< Number of nets created.
+        uint64_t cachedBytes = 0;   ///< Size of the model files copied into memory, including the released ones.
+        uint64_t mappedBytes = 0;   ///< Size of the memory-mapped model files.
+    };
+
+    /*!
+     * \brief Returns the registry shared by the whole process.
+     */
+    static ModelRegistry& instance();
+
+    /*!
+     * \brief Selects whether model files loaded from now on are memory-mapped or read into memory.
+     * \param enabled True to memory-map the files. Disabled by default.
+     */
+    void setMemoryMapping(bool enabled);
+
+    /*!
+     * \brief Reads the model files into the cache unless they are already there.
+     * \param cfgPath Path to the Darknet configuration file, or empty for an ONNX model.
+     * \param weightsPath Path to the Darknet weights file, or to the ONNX model when cfgPath is empty.
+     * \return False if a file could not be read.
+     */
+    bool preload(const std::string& cfgPath, const std::string& weightsPath);
+
+    /*!
+     * \brief Creates a new network from the cached model files.
+     * \param cfgPath Path to the Darknet configuration file, or empty for an ONNX model.
+     * \param weightsPath Path to the Darknet weights file, or to the ONNX model when cfgPath is empty.
+     * \return A network owned by the caller, or an empty one if the files could not be read.
+     * \details Loads the files first if needed. Safe to call from several threads; the parsing itself
+     * runs outside the registry lock.
+     */
+    cv::dnn::Net createNet(const std::string& cfgPath, const std::string& weightsPath);
+
+    /*!
+     * \brief Drops the cached files that were read into memory.
+     * \details Call it once every network of the process is built: a read model would otherwise keep a
+     * private heap copy of its weights for the process lifetime. Networks already built are not
+     * affected; creating another one afterwards reads the files again. Memory-mapped files stay cached,
+     * since their pages belong to the page cache and are reclaimed by the kernel.
+     */
+    void releaseCopies();
+
+    /*!
+     * \brief Returns the load statistics.
+     */
+    Stats stats() const;
+
+private:
+    ModelRegistry() = default;
+
+    /*!
+     * \brief Content of one model file, either copied into memory or memory-mapped.
+     */
+    struct ModelFile {
+        std::vector<char> buffer;   ///< Bytes of the file when it was read.
+        MappedFile mapping;         ///< Mapping of the file when it was memory-mapped.
+
+        /*!
+         * \brief Loads the file.
+         * \param path The file to be loaded.
+         * \param memoryMapped True to map the file instead of reading it.
+         * \return False if the file could not be loaded.
+         */
+        bool load(const std::string& path, bool memoryMapped);
+
+        /*!
+         * \brief Returns whether the file is memory-mapped.
+         */
+        bool isMapped() const;
+
+        /*!
+         * \brief Returns the first byte of the file.
+         */
+        const char* data() const;
+
+        /*!
+         * \brief Returns the size of the file in bytes.
+         */
+        size_t size() const;
+    };
+
+    /*!
+     * \brief Content of the files of one model.
+     */
+    struct ModelFiles {
+        ModelFile cfg;      ///< Darknet configuration file; empty for ONNX models.
+        ModelFile weights;  ///< Darknet weights file or ONNX model.
+    };
+
+    /*!
+     * \brief Returns the cached files of a model, reading them on first use.
+     * \return The files, or nullptr if one could not be read.
+     */
+    std::shared_ptr<const ModelFiles> load(const std::string& cfgPath, const std::string& weightsPath);
+
+    /*!
+     * \brief Reads a whole file.
+     * \param path The file to be read.
+     * \param content Receives the bytes of the file.
+     * \return False if the file could not be read.
+     */
+    static bool readFile(const std::string& path, std::vector<char>& content);
+
+private:
+    mutable std::mutex registryMutex;                               ///< Guards models, memoryMapping and modelStats.
+    bool memoryMapping = false;                                      ///< Whether new model files are memory-mapped.
+    std::map<std::string, std::shared_ptr<const ModelFiles>> models; ///< Cached files by cfg and weights path.
+    Stats modelStats;                                                ///< Load statistics.
+};
+
+#endif // MODELREGISTRY_H
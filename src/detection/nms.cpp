@@ -0,0 +1,106 @@
+#include "nms.h"
+#include <algorithm>
+#include <numeric>
+#include <opencv2/core/hal/intrin.hpp>
+
+NonMaxSuppressor::NonMaxSuppressor(float iouThreshold)
+    : iouThreshold(iouThreshold)
+{
+
+}
+
+void NonMaxSuppressor::run(const std::vector<Detection> &candidates, std::vector<int> &keptIndices)
+{
+    keptIndices.clear();
+    const size_t count = candidates.size();
+    if (count == 0) return;
+
+    order.resize(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&candidates](int a, int b) {
+        const Detection& left = candidates[a];
+        const Detection& right = candidates[b];
+        if (left.classId != right.classId) return left.classId < right.classId;
+        return left.score > right.score;
+    });
+
+    x1.resize(count);
+    y1.resize(count);
+    x2.resize(count);
+    y2.resize(count);
+    area.resize(count);
+    suppressed.assign(count, 0);
+    for (size_t i = 0; i < count; ++i) {
+        const cv::Rect2f& box = candidates[order[i]].box;
+        x1[i] = box.x;
+        y1[i] = box.y;
+        x2[i] = box.x + box.width;
+        y2[i] = box.y + box.height;
+        area[i] = std::max(box.width, 0.0f) * std::max(box.height, 0.0f);
+    }
+
+    const float* left = x1.data();
+    const float* top = y1.data();
+    const float* right = x2.data();
+    const float* bottom = y2.data();
+    const float* areas = area.data();
+    uint32_t* removed = suppressed.data();
+    const float threshold = iouThreshold;
+
+    size_t classBegin = 0;
+    while (classBegin < count) {
+        const int classId = candidates[order[classBegin]].classId;
+        size_t classEnd = classBegin + 1;
+        while (classEnd < count && candidates[order[classEnd]].classId == classId) {
+            ++classEnd;
+        }
+
+        for (size_t i = classBegin; i < classEnd; ++i) {
+            if (removed[i]) continue;
+            keptIndices.push_back(order[i]);
+
+            const float keptLeft = left[i];
+            const float keptTop = top[i];
+            const float keptRight = right[i];
+            const float keptBottom = bottom[i];
+            const float keptArea = areas[i];
+
+            // IoU > t  <=>  inter > t * (areaA + areaB - inter), so there is no division and no branch
+            size_t j = i + 1;
+#if CV_SIMD
+            const size_t lanes = cv::v_float32::nlanes;
+            const cv::v_float32 zero = cv::vx_setzero_f32();
+            const cv::v_float32 keptLeftLanes = cv::vx_setall_f32(keptLeft);
+            const cv::v_float32 keptTopLanes = cv::vx_setall_f32(keptTop);
+            const cv::v_float32 keptRightLanes = cv::vx_setall_f32(keptRight);
+            const cv::v_float32 keptBottomLanes = cv::vx_setall_f32(keptBottom);
+            const cv::v_float32 keptAreaLanes = cv::vx_setall_f32(keptArea);
+            const cv::v_float32 thresholdLanes = cv::vx_setall_f32(threshold);
+            const cv::v_uint32 one = cv::vx_setall_u32(1);
+            for (; j + lanes <= classEnd; j += lanes) {
+                cv::v_float32 width = cv::v_max(zero, cv::v_min(keptRightLanes, cv::vx_load(right + j)) - cv::v_max(keptLeftLanes, cv::vx_load(left + j)));
+                cv::v_float32 height = cv::v_max(zero, cv::v_min(keptBottomLanes, cv::vx_load(bottom + j)) - cv::v_max(keptTopLanes, cv::vx_load(top + j)));
+                cv::v_float32 intersection = width * height;
+                // The comparison gives an all-ones lane per overlapping box; keep its low bit as the flag
+                cv::v_float32 overlaps = intersection > thresholdLanes * (keptAreaLanes + cv::vx_load(areas + j) - intersection);
+                cv::v_store(removed + j, cv::vx_load(removed + j) | (cv::v_reinterpret_as_u32(overlaps) & one));
+            }
+#endif
+            for (; j < classEnd; ++j) {
+                float width = std::max(0.0f, std::min(keptRight, right[j]) - std::max(keptLeft, left[j]));
+                float height = std::max(0.0f, std::min(keptBottom, bottom[j]) - std::max(keptTop, top[j]));
+                float intersection = width * height;
+                removed[j] |= static_cast<uint32_t>(intersection > threshold * (keptArea + areas[j] - intersection));
+            }
+        }
+        classBegin = classEnd;
+    }
+#if CV_SIMD
+    cv::vx_cleanup();
+#endif
+}
+
+float NonMaxSuppressor::getIouThreshold() const
+{
+    return iouThreshold;
+}
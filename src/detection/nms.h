@@ -0,0 +1,59 @@
+#ifndef NMS_H
+#define NMS_H
+
+#include <cstdint>
+#include <vector>
+#include <opencv2/core.hpp>
+
+/*!
+ * \brief A box proposed by the detector, before suppression.
+ */
+struct Detection {
+    cv::Rect2f box;     ///< Box in image pixels.
+    float score;        ///< Confidence of the class.
+    int classId;        ///< Index of the class in the class list.
+};
+
+/*!
+ * \brief Class-aware greedy Non-Maximum Suppression.
+ * \details Candidates are sorted by class and by descending score. Within each class the best remaining
+ * box is kept and every later box overlapping it by more than the IoU threshold is suppressed; boxes
+ * of different classes never suppress each other. The boxes are copied into structure-of-arrays
+ * scratch buffers, so the inner IoU loop is a branchless pass over contiguous floats, written with the
+ * OpenCV universal intrinsics and a scalar tail. The suppression flags are 32-bit, one per lane of the
+ * float comparison mask. The scratch buffers are kept between calls, so one instance per worker thread allocates
+ * only while the candidate count grows.
+ */
+class NonMaxSuppressor {
+public:
+    /*!
+     * \brief Constructs a NonMaxSuppressor.
+     * \param iouThreshold Boxes overlapping a kept box of the same class by more than this IoU are suppressed.
+     */
+    explicit NonMaxSuppressor(float iouThreshold = 0.45f);
+
+    /*!
+     * \brief Runs the suppression.
+     * \param candidates The detections to be filtered.
+     * \param keptIndices Receives the indices of the kept candidates, grouped by class and by descending score within a class.
+     */
+    void run(const std::vector<Detection>& candidates, std::vector<int>& keptIndices);
+
+    /*!
+     * \brief Gets the IoU threshold.
+     * \return The IoU above which a box is suppressed.
+     */
+    float getIouThreshold() const;
+
+private:
+    float iouThreshold;                 ///< IoU above which a box is suppressed.
+    std::vector<int> order;             ///< Candidate indices sorted by class, then by descending score.
+    std::vector<float> x1;              ///< Left edges, in sorted order.
+    std::vector<float> y1;              ///< Top edges, in sorted order.
+    std::vector<float> x2;              ///< Right edges, in sorted order.
+    std::vector<float> y2;              ///< Bottom edges, in sorted order.
+    std::vector<float> area;            ///< Box areas, in sorted order.
+    std::vector<uint32_t> suppressed;   ///< Non-zero once a box is suppressed, in sorted order.
+};
+
+#endif // NMS_H
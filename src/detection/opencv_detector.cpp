@@ -0,0 +1,122 @@
+#include "opencv_detector.h"
+#include "yolo_decoder.h"
+#include "model_registry.h"
+#include <algorithm>
+#include <iostream>
+
+OpenCvDetector::OpenCvDetector(cv::dnn::Net net, bool darknet, Backend backend, Precision precision,
+                               float confidenceThreshold, int inputSize)
+    : net(std::move(net))
+    , darknet(darknet)
+    , confidenceThreshold(confidenceThreshold)
+    , inputSize(inputSize)
+{
+    configure(backend, precision);
+    outputNames = this->net.getUnconnectedOutLayersNames();
+}
+
+std::unique_ptr<IDetector> OpenCvDetector::create(const std::string &cfgPath, const std::string &weightsPath,
+                                                  Backend backend, Precision precision,
+                                                  float confidenceThreshold, int inputSize)
+{
+    // Parsed from the files cached by the registry; each detector owns its net, weights included, and forward state
+    cv::dnn::Net net = ModelRegistry::instance().createNet(cfgPath, weightsPath);
+    if (net.empty()) {
+        return nullptr;
+    }
+    return std::make_unique<OpenCvDetector>(std::move(net), !cfgPath.empty(), backend, precision,
+                                            confidenceThreshold, inputSize);
+}
+
+bool OpenCvDetector::isQuantized(const cv::dnn::Net &net)
+{
+    // QuantizeLinear nodes of ONNX models are imported as Quantize layers
+    std::vector<std::string> layerTypes;
+    net.getLayerTypes(layerTypes);
+    return std::find(layerTypes.begin(), layerTypes.end(), "Quantize") != layerTypes.end();
+}
+
+void OpenCvDetector::forward(const cv::Mat &blob)
+{
+    frameCount = static_cast<size_t>(blob.size[0]);
+    net.setInput(blob);
+    net.forward(outputs, outputNames);
+}
+
+void OpenCvDetector::decode(size_t frame, const LetterboxTransform &transform, std::vector<Detection> &candidates)
+{
+    for (const cv::Mat& output : outputs) {
+        cv::Mat rows = batchSlice(output, frame, frameCount);
+
+        // Darknet region layers emit normalized boxes; ONNX exports emit them in input pixels
+        YoloDecoder::Layout layout = YoloDecoder::Layout::Darknet;
+        float boxScale = 1.0f;
+        if (!darknet) {
+            boxScale = 1.0f / static_cast<float>(inputSize);
+            if (rows.rows < rows.cols) {
+                // Channel-major [4 + classes, anchors] output of the anchor-free heads
+                cv::transpose(rows, transposed);
+                rows = transposed;
+                layout = YoloDecoder::Layout::AnchorFree;
+            } else {
+                layout = YoloDecoder::Layout::Objectness;
+            }
+        }
+        YoloDecoder(confidenceThreshold, layout, boxScale).decode(rows, transform, candidates);
+    }
+}
+
+cv::Mat OpenCvDetector::batchSlice(const cv::Mat &output, size_t frame, size_t frameCount)
+{
+    // A YOLO output is [rows, columns] for one frame and [frames, rows, columns] for a batch; view both as 2D rows
+    const int columns = output.size[output.dims - 1];
+    cv::Mat rows = output.reshape(1, static_cast<int>(output.total() / columns));
+    const int rowsPerFrame = rows.rows / static_cast<int>(frameCount);
+    return rows.rowRange(static_cast<int>(frame) * rowsPerFrame, static_cast<int>(frame + 1) * rowsPerFrame);
+}
+
+bool OpenCvDetector::configure(Backend backend, Precision precision)
+{
+    cv::dnn::Backend dnnBackend = cv::dnn::DNN_BACKEND_OPENCV;
+    cv::dnn::Target dnnTarget = cv::dnn::DNN_TARGET_CPU;
+    bool supported = true;
+
+    switch (backend) {
+    case Backend::OpenCV:
+        dnnBackend = cv::dnn::DNN_BACKEND_OPENCV;
+        break;
+    case Backend::OpenVINO:
+        dnnBackend = cv::dnn::DNN_BACKEND_INFERENCE_ENGINE;
+        break;
+    case Backend::Halide:
+        dnnBackend = cv::dnn::DNN_BACKEND_HALIDE;
+        break;
+    }
+
+    if (precision == Precision::FP16) {
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 8)
+        dnnTarget = cv::dnn::DNN_TARGET_CPU_FP16;
+#else
+        supported = false; // No half precision CPU target before OpenCV 4.8
+#endif
+    } else if (precision == Precision::INT8) {
+        // The precision comes from the model; its int8 layers only run on the OpenCV backend
+        if (!isQuantized(net)) {
+            std::cerr << "Error: INT8 needs a quantized model, running this one in FP32." << std::endl;
+        }
+        supported = backend == Backend::OpenCV;
+    }
+
+    // Only the pairs this build and this CPU can run are listed
+    std::vector<std::pair<cv::dnn::Backend, cv::dnn::Target>> available = cv::dnn::getAvailableBackends();
+    supported = supported && std::find(available.begin(), available.end(), std::make_pair(dnnBackend, dnnTarget)) != available.end();
+    if (!supported) {
+        std::cerr << "Error: The selected inference backend and precision are not available, using OpenCV in FP32." << std::endl;
+        dnnBackend = cv::dnn::DNN_BACKEND_OPENCV;
+        dnnTarget = cv::dnn::DNN_TARGET_CPU;
+    }
+
+    net.setPreferableBackend(dnnBackend);
+    net.setPreferableTarget(dnnTarget);
+    return supported;
+}
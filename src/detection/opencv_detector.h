@@ -0,0 +1,90 @@
+#ifndef OPENCVDETECTOR_H
+#define OPENCVDETECTOR_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <opencv2/dnn.hpp>
+#include "idetector.h"
+
+/*!
+ * \brief Detector running YOLO models with the OpenCV DNN module.
+ * \details Works with Darknet models, whose region layers emit normalized boxes, and with ONNX exports of
+ * newer YOLO variants, whose outputs hold boxes in input pixels; the layout of each ONNX output is
+ * recognized from its shape. The backend and precision are applied when the detector is built; a
+ * combination this OpenCV build does not provide falls back to the OpenCV backend in FP32. Quantized
+ * ONNX models run on OpenCV's int8 layers, which only exist for the OpenCV backend on the CPU.
+ */
+class OpenCvDetector : public IDetector {
+public:
+    /*!
+     * \brief Constructs an OpenCvDetector.
+     * \param net The network, owned by the detector from now on.
+     * \param darknet True for a Darknet model, false for an ONNX model.
+     * \param backend Backend the network should run on.
+     * \param precision Precision the network should run in.
+     * \param confidenceThreshold Minimum class confidence of a candidate.
+     * \param inputSize Width and height of the network input.
+     */
+    OpenCvDetector(cv::dnn::Net net, bool darknet, Backend backend, Precision precision,
+                   float confidenceThreshold, int inputSize);
+
+    /*!
+     * \brief Creates a detector with a network built from the ModelRegistry.
+     * \param cfgPath Path to the Darknet configuration file, or empty for an ONNX model.
+     * \param weightsPath Path to the Darknet weights file, or to the ONNX model when cfgPath is empty.
+     * \param backend Backend the network should run on.
+     * \param precision Precision the network should run in.
+     * \param confidenceThreshold Minimum class confidence of a candidate.
+     * \param inputSize Width and height of the network input.
+     * \return The detector, or nullptr if the model could not be loaded.
+     */
+    static std::unique_ptr<IDetector> create(const std::string& cfgPath, const std::string& weightsPath,
+                                             Backend backend, Precision precision,
+                                             float confidenceThreshold, int inputSize);
+
+    /*!
+     * \brief Tells whether a network holds quantized layers.
+     * \param net The network.
+     * \return True if the network quantizes its activations somewhere, as INT8 ONNX exports do.
+     */
+    static bool isQuantized(const cv::dnn::Net& net);
+
+    /*!
+     * \brief Runs a batch through the network and keeps its outputs for decode().
+     */
+    void forward(const cv::Mat& blob) override;
+
+    /*!
+     * \brief Decodes the outputs of one frame of the last batch.
+     */
+    void decode(size_t frame, const LetterboxTransform& transform, std::vector<Detection>& candidates) override;
+
+    /*!
+     * \brief Returns the rows of one frame in a network output.
+     * \param output Output of one YOLO layer, 2D for a single frame or 3D for a batch.
+     * \param frame Index of the frame within the batch.
+     * \param frameCount Number of frames in the batch.
+     * \return A 2D view of the frame's rows; no data is copied.
+     */
+    static cv::Mat batchSlice(const cv::Mat& output, size_t frame, size_t frameCount);
+
+private:
+    /*!
+     * \brief Selects the backend and target of the network.
+     * \return False if the combination is not available, in which case the OpenCV backend in FP32 is used.
+     */
+    bool configure(Backend backend, Precision precision);
+
+private:
+    cv::dnn::Net net;                           ///< The network.
+    bool darknet;                               ///< Whether the network was read from a Darknet model.
+    float confidenceThreshold;                  ///< Minimum class confidence of a candidate.
+    int inputSize;                              ///< Width and height of the network input.
+    std::vector<std::string> outputNames;       ///< Names of the output layers.
+    std::vector<cv::Mat> outputs;               ///< Outputs of the last batch.
+    size_t frameCount = 0;                      ///< Number of frames in the last batch.
+    cv::Mat transposed;                         ///< Scratch for the rows of channel-major outputs.
+};
+
+#endif // OPENCVDETECTOR_H
@@ -0,0 +1,76 @@
+#include "yolo_decoder.h"
+#include <algorithm>
+#include <opencv2/core/hal/intrin.hpp>
+
+namespace {
+
+const int kObjectnessColumn = 4;    // Columns 0-3 hold the box
+const int kFirstClassColumn = 5;
+
+} // namespace
+
+YoloDecoder::YoloDecoder(float confidenceThreshold, Layout layout, float boxScale)
+    : confidenceThreshold(confidenceThreshold)
+    , layout(layout)
+    , boxScale(boxScale)
+{
+
+}
+
+void YoloDecoder::decode(const cv::Mat &rows, const LetterboxTransform &transform, std::vector<Detection> &candidates) const
+{
+    const bool hasObjectness = layout != Layout::AnchorFree;
+    const int firstClassColumn = hasObjectness ? kFirstClassColumn : kObjectnessColumn;
+    const int classCount = rows.cols - firstClassColumn;
+    if (classCount <= 0) return;
+
+    const float scaleX = transform.scaleX * boxScale;
+    const float scaleY = transform.scaleY * boxScale;
+    for (int i = 0; i < rows.rows; ++i) {
+        const float* row = rows.ptr<float>(i);
+
+        // The class confidence never exceeds the objectness, so this rejects the row exactly
+        if (hasObjectness && row[kObjectnessColumn] <= confidenceThreshold) continue;
+
+        float confidence = 0.0f;
+        int objectClass = argmax(row + firstClassColumn, classCount, confidence);
+        if (layout == Layout::Objectness) {
+            confidence *= row[kObjectnessColumn];
+        }
+        if (confidence <= confidenceThreshold) continue;
+
+        float width = row[2] * scaleX;
+        float height = row[3] * scaleY;
+        float x = row[0] * scaleX + transform.offsetX - width / 2;
+        float y = row[1] * scaleY + transform.offsetY - height / 2;
+        candidates.push_back({ cv::Rect2f(x, y, width, height), confidence, objectClass });
+    }
+}
+
+int YoloDecoder::argmax(const float *scores, int count, float &best)
+{
+    int i = 0;
+    best = scores[0];
+#if CV_SIMD
+    const int lanes = cv::v_float32::nlanes;
+    if (count >= lanes) {
+        // Lane-wise maximum, then one horizontal reduction
+        cv::v_float32 maximum = cv::vx_load(scores);
+        for (i = lanes; i + lanes <= count; i += lanes) {
+            maximum = cv::v_max(maximum, cv::vx_load(scores + i));
+        }
+        best = cv::v_reduce_max(maximum);
+        cv::vx_cleanup();
+    }
+#endif
+    for (; i < count; ++i) {
+        best = std::max(best, scores[i]);
+    }
+
+    // The first score equal to the maximum; same result as std::max_element
+    int index = 0;
+    while (index < count - 1 && scores[index] != best) {
+        ++index;
+    }
+    return index;
+}
@@ -0,0 +1,60 @@
+#ifndef YOLODECODER_H
+#define YOLODECODER_H
+
+#include <vector>
+#include <opencv2/core.hpp>
+#include "nms.h"
+#include "letterbox.h"
+
+/*!
+ * \brief Turns the rows of a YOLO output layer into detection candidates.
+ * \details Every row holds the box (columns 0-3), an objectness (column 4) for the layouts that have one,
+ * and one score per class. With an objectness no class can beat the threshold in a row whose objectness
+ * does not, since the class confidence is the product of both; such rows, the vast majority, are rejected
+ * after reading a single float. Only the surviving rows get the argmax over their class scores, which runs
+ * on the OpenCV universal intrinsics when they are available. Rows are walked through raw pointers in
+ * memory order, without the bounds checks of `Mat::at`.
+ */
+class YoloDecoder {
+public:
+    /*!
+     * \brief Layout of the rows of an output layer.
+     */
+    enum class Layout {
+        Darknet,    ///< Normalized center and size, objectness, class scores already multiplied by it (OpenCV region layer).
+        Objectness, ///< Center and size in input pixels, objectness, raw class scores (YOLOv5-style ONNX exports).
+        AnchorFree  ///< Center and size in input pixels and class scores, no objectness (YOLOv8-style ONNX exports).
+    };
+
+    /*!
+     * \brief Constructs a YoloDecoder.
+     * \param confidenceThreshold Minimum class confidence of a candidate.
+     * \param layout Layout of the rows.
+     * \param boxScale Factor that normalizes the box columns to [0, 1]: 1 for Darknet, 1 / input size for the others.
+     */
+    explicit YoloDecoder(float confidenceThreshold, Layout layout = Layout::Darknet, float boxScale = 1.0f);
+
+    /*!
+     * \brief Appends the candidates of one output layer.
+     * \param rows Rows of one frame, CV_32F, one detection per row.
+     * \param transform Maps the normalized boxes to frame pixels, see LetterboxPreprocessor::apply.
+     * \param candidates Receives the detections whose class confidence beats the threshold.
+     */
+    void decode(const cv::Mat& rows, const LetterboxTransform& transform, std::vector<Detection>& candidates) const;
+
+    /*!
+     * \brief Finds the highest score.
+     * \param scores The scores to be searched.
+     * \param count Number of scores; must be at least 1.
+     * \param best Receives the highest score.
+     * \return Index of the first occurrence of the highest score.
+     */
+    static int argmax(const float* scores, int count, float& best);
+
+private:
+    float confidenceThreshold; ///< Minimum class confidence of a candidate.
+    Layout layout;             ///< Layout of the rows.
+    float boxScale;            ///< Factor that normalizes the box columns.
+};
+
+#endif // YOLODECODER_H
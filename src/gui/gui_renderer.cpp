@@ -40,8 +40,8 @@ void GUIRenderer::processEvents() {
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init("#version 330");
 
-    GLuint texture1 = 0; // Texture ID for frames.first
-    GLuint texture2 = 0; // Texture ID for frames.second
+    GLuint texture1 = 0; // Texture ID for the original frame
+    GLuint texture2 = 0; // Texture ID for the processed frame
 
     while (running.load() && !glfwWindowShouldClose(window)) {
         glfwPollEvents();
@@ -57,22 +57,18 @@ void GUIRenderer::processEvents() {
         ImGui::Begin("Object Detection");
 
         {
-            std::unique_lock<std::mutex> lock(queueMutex);
-            queueCondition.wait(lock, [this]() { return !frameQueue.empty() || !running.load(); });
-
-            if (!running.load()) break; // Exit if not running
-
-            std::pair<cv::Mat, cv::Mat> frames = frameQueue.front();
-            frameQueue.pop();
-            lock.unlock();
-
-            // Render frames.first
-            renderFrame(frames.first, texture1, "Unsupported image format for orjinal video frame");
-            frames.first.release();
-
-            // Render frames.second
-            renderFrame(frames.second, texture2, "Unsupported image format for processed video frame");
-            frames.second.release();
+            uint64_t ticket = 0;
+            std::optional<Event> event = waitForEvent(ticket);
+            if (!event) break; // Exit if not running
+
+            // Render the original frame
+            renderFrame(event->data.first, texture1, "Unsupported image format for orjinal video frame");
+            event->data.first.release();
+
+            // Render the processed frame
+            renderFrame(event->data.second, texture2, "Unsupported image format for processed video frame");
+            event->data.second.release();
+            stampStageExit(*event);
         }
 
         ImGui::End();
@@ -87,7 +83,10 @@ void GUIRenderer::processEvents() {
         glfwSwapBuffers(window);
     }
 
-    // Shutdown and cleanup
+    // Shutdown and cleanup. No more frames are consumed, so release producers blocked on our queue
+    // before the dispatcher stops.
+    running.store(false);
+    spaceCondition.notify_all();
     dispatcher.shutdownEventloop();
 
     glDeleteTextures(1, &texture1);
@@ -109,6 +108,11 @@ std::thread GUIRenderer::getThreadInfo()
     return std::thread(&GUIRenderer::processEvents, this);
 }
 
+std::string GUIRenderer::getStageName() const
+{
+    return "gui";
+}
+
 void GUIRenderer::renderFrame(const cv::Mat &frame, GLuint &texture, const std::string &errorMessage) {
     if (!frame.empty()) {
         cv::Mat imgRGBA;
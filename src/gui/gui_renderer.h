@@ -55,6 +55,12 @@ private:
      */
     std::thread getThreadInfo() override;
 
+    /*!
+     * \brief Gets the name of this stage.
+     * \return "gui", the `stage` label of its metrics.
+     */
+    std::string getStageName() const override;
+
 private:
     /*!
     * \brief Renders a given frame to an OpenGL texture and displays it using ImGui.
@@ -0,0 +1,84 @@
+#include "headless_sink.h"
+#include <iostream>
+
+HeadlessSink::HeadlessSink(EventDispatcher &dispatcher, const std::string &outputPath, uint64_t maxFrames, double outputFps)
+    : IProcessor(dispatcher)
+    , outputPath(outputPath)
+    , maxFrames(maxFrames)
+    , outputFps(outputFps)
+    , consumedFrames(0)
+    , firstFrameNs(0)
+    , lastFrameNs(0)
+{
+
+}
+
+HeadlessSink::~HeadlessSink() {
+    stop();
+}
+
+uint64_t HeadlessSink::frameCount() const
+{
+    return consumedFrames.load();
+}
+
+double HeadlessSink::averageFps() const
+{
+    uint64_t frames = consumedFrames.load();
+    int64_t elapsedNs = lastFrameNs.load() - firstFrameNs.load();
+    if (frames < 2 || elapsedNs <= 0) return 0.0;
+    return static_cast<double>(frames - 1) * 1e9 / static_cast<double>(elapsedNs);
+}
+
+void HeadlessSink::processEvents() {
+    cv::VideoWriter writer;
+    bool writeFailed = false;
+
+    while (running.load()) {
+        uint64_t ticket = 0;
+        std::optional<Event> event = waitForEvent(ticket);
+        if (!event) break; // Exit if not running
+
+        if (!outputPath.empty() && !writeFailed && !event->data.second.empty()) {
+            if (!writer.isOpened()) {
+                cv::Size frameSize(event->data.second.cols, event->data.second.rows);
+                if (!writer.open(outputPath, cv::VideoWriter::fourcc('m', 'p', '4', 'v'), outputFps, frameSize)) {
+                    std::cerr << "Error: Could not open output file: " << outputPath << std::endl;
+                    writeFailed = true; // Keep counting, stop trying to write
+                }
+            }
+            if (writer.isOpened()) {
+                writer.write(event->data.second);
+            }
+        }
+        stampStageExit(*event);
+
+        int64_t nowNs = Event::monotonicNowNs();
+        if (consumedFrames.load() == 0) {
+            firstFrameNs.store(nowNs);
+        }
+        lastFrameNs.store(nowNs);
+        uint64_t frames = consumedFrames.fetch_add(1) + 1;
+
+        if (maxFrames != 0 && frames == maxFrames) {
+            dispatcher.shutdownEventloop();
+        }
+    }
+
+    writer.release();
+}
+
+Event::Type HeadlessSink::getAccessibleType()
+{
+    return Event::Type::FrameDetectionReady;
+}
+
+std::thread HeadlessSink::getThreadInfo()
+{
+    return std::thread(&HeadlessSink::processEvents, this);
+}
+
+std::string HeadlessSink::getStageName() const
+{
+    return "sink";
+}
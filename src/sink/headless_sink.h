@@ -0,0 +1,103 @@
+#ifndef HEADLESSSINK_H
+#define HEADLESSSINK_H
+
+#include <string>
+#include <thread>
+#include <atomic>
+#include <opencv2/opencv.hpp>
+#include "iprocessor.h"
+
+/*!
+ * \brief Terminal stage used instead of the GUIRenderer when no display is available.
+ * \details The HeadlessSink consumes the final events of the pipeline without GLFW or ImGui.
+ * It counts every frame and either writes the processed frames to a video file or discards them.
+ * It can also end the run after a fixed number of frames by shutting down the EventDispatcher.
+ */
+class HeadlessSink : public IProcessor {
+public:
+    /*!
+     * \brief Constructs a HeadlessSink object.
+     * \param dispatcher Reference to the EventDispatcher used for posting and handling events.
+     * \param outputPath Video file the processed frames are written to; empty discards them.
+     * \param maxFrames Number of frames after which the event loop is shut down; 0 runs until stopped.
+     * \param outputFps Frame rate stored in the output file.
+     */
+    HeadlessSink(EventDispatcher& dispatcher, const std::string& outputPath = "", uint64_t maxFrames = 0, double outputFps = 25.0);
+
+    /*!
+     * \brief Destructs the HeadlessSink object.
+     * \details Stops the worker thread, which closes the output file.
+     */
+    ~HeadlessSink();
+
+    /*!
+     * \brief Returns the number of frames that reached the sink.
+     * \return Count of consumed frames since start.
+     */
+    uint64_t frameCount() const;
+
+    /*!
+     * \brief Returns the average rate at which frames reached the sink.
+     * \return Frames per second between the first and the last consumed frame, or 0 before two frames arrived.
+     */
+    double averageFps() const;
+
+private:
+    /*!
+     * \brief Consumes the final events of the pipeline.
+     * \details This method overrides the processEvents function from the IProcessor interface.
+     * The output file is opened on the first frame, once the frame size is known.
+     */
+    void processEvents() override;
+
+    /*!
+     * \brief Retrieves the type of events that the HeadlessSink can handle.
+     * \return Event::Type::FrameDetectionReady, the last event of the pipeline.
+     */
+    Event::Type getAccessibleType() override;
+
+    /*!
+     * \brief Retrieves the thread consuming the final events.
+     * \return A std::thread object running processEvents.
+     */
+    std::thread getThreadInfo() override;
+
+    /*!
+     * \brief Gets the name of this stage.
+     * \return "sink", the `stage` label of its metrics.
+     */
+    std::string getStageName() const override;
+
+private:
+    /*!
+     * \brief Path of the output video file; empty when frames are discarded.
+     */
+    std::string outputPath;
+
+    /*!
+     * \brief Number of frames after which the event loop is shut down; 0 means unlimited.
+     */
+    uint64_t maxFrames;
+
+    /*!
+     * \brief Frame rate stored in the output file.
+     */
+    double outputFps;
+
+    /*!
+     * \brief Number of frames consumed so far.
+     */
+    std::atomic<uint64_t> consumedFrames;
+
+    /*!
+     * \brief Monotonic time the first frame was consumed, in nanoseconds.
+     */
+    std::atomic<int64_t> firstFrameNs;
+
+    /*!
+     * \brief Monotonic time the last frame was consumed, in nanoseconds.
+     */
+    std::atomic<int64_t> lastFrameNs;
+};
+
+#endif // HEADLESSSINK_H
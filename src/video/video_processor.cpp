@@ -1,9 +1,11 @@
 #include "video_processor.h"
+#include "frame_pool.h"
 #include <iostream>
 
-VideoProcessor::VideoProcessor(const std::string& videoPath, EventDispatcher& dispatcher)
+VideoProcessor::VideoProcessor(const std::string& videoPath, EventDispatcher& dispatcher, uint32_t sourceId)
     : IProcessor(dispatcher)
     , videoPath(videoPath)
+    , sourceId(sourceId)
 {
 
 }
@@ -12,6 +14,11 @@ VideoProcessor::~VideoProcessor() {
     stop();
 }
 
+void VideoProcessor::setRealtime(bool enabled)
+{
+    realtime = enabled;
+}
+
 void VideoProcessor::processEvents() {
     cv::VideoCapture capture(videoPath);
     if (!capture.isOpened()) {
@@ -22,16 +29,39 @@ void VideoProcessor::processEvents() {
     double fps = capture.get(cv::CAP_PROP_FPS);
 
     cv::Mat frame;
+    bool slotAcquired = false;
+    bool slotReserved = false;
     while (running.load()) {
+        // Under the block policy, only capture once the defogger has room for the frame
+        if (!slotAcquired && downstream && !downstream->acquireSlot(running, slotReserved)) {
+            break;
+        }
+        slotAcquired = true; // Kept across a rewind, until a frame is posted
+        FramePool::instance().attach(frame); // Decode into a recycled buffer
+        int64_t readStartNs = Event::monotonicNowNs();
         if (!capture.read(frame)) {
             // Reset to the beginning of the video
             capture.set(cv::CAP_PROP_POS_FRAMES, 0);
             continue; // Start reading frames from the beginning again
         }
 
-        dispatcher.postEvent(Event(Event::Type::FrameCaptureReady, std::make_pair(frame, frame)));
-        std::this_thread::sleep_for(std::chrono::milliseconds((int)(1000 / fps))); // Adjust sleep duration as needed
-        frame.release();
+        // Both halves share the captured buffer: the original is kept for display, the second
+        // one is replaced by the defogger. Moving leaves frame empty for the next read.
+        Event event(Event::Type::FrameCaptureReady, std::make_pair(frame, std::move(frame)));
+        event.sequenceId = nextSequenceId++;
+        event.sourceId = sourceId;
+        event.captureTimestampNs = Event::monotonicNowNs();
+        Event::StageTiming& captureTiming = event.timing(getAccessibleType());
+        captureTiming.enterNs = readStartNs;
+        captureTiming.startNs = readStartNs;
+        event.slotReserved = slotReserved;
+        stampStageExit(event);
+        dispatcher.postEvent(std::move(event));
+        slotAcquired = false;
+        slotReserved = false;
+        if (realtime && fps > 0.0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds((int)(1000 / fps))); // Adjust sleep duration as needed
+        }
     }
     capture.release();
 }
@@ -45,3 +75,8 @@ std::thread VideoProcessor::getThreadInfo()
 {
     return std::thread(&VideoProcessor::processEvents, this);
 }
+
+std::string VideoProcessor::getStageName() const
+{
+    return "capture";
+}
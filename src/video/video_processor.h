@@ -16,8 +16,9 @@ public:
      * \brief Constructs a VideoProcessor with the given video path and EventDispatcher.
      * \param videoPath The path to the video file to be processed.
      * \param dispatcher Reference to an EventDispatcher used for event handling.
+     * \param sourceId Identifier stamped on every frame of this video, see Event::sourceId.
      */
-    VideoProcessor(const std::string& videoPath, EventDispatcher& dispatcher);
+    VideoProcessor(const std::string& videoPath, EventDispatcher& dispatcher, uint32_t sourceId = 0);
 
     /*!
      * \brief Destroys the VideoProcessor object.
@@ -25,6 +26,14 @@ public:
      */
     ~VideoProcessor();
 
+    /*!
+     * \brief Selects whether frames are read at the frame rate of the video.
+     * \param enabled True sleeps one frame interval after every frame; false reads as fast as the decoder allows.
+     * \details Must be called before start(). Disabling it is meant for throughput runs and should be combined
+     * with a bounded, blocking stage queue, otherwise capture outruns the slower stages.
+     */
+    void setRealtime(bool enabled);
+
 protected:
     /*!
      * \brief Processes events related to video processing.
@@ -46,12 +55,33 @@ protected:
      */
     std::thread getThreadInfo() override;
 
+    /*!
+     * \brief Gets the name of this stage.
+     * \return "capture", the `stage` label of its metrics.
+     */
+    std::string getStageName() const override;
+
 private:
     /*!
      * \brief Path to the video file to be processed.
      * \details Stores the file path of the video from which frames will be extracted and processed.
      */
     std::string videoPath;
+
+    /*!
+     * \brief Identifier of this source, stamped on every captured frame.
+     */
+    uint32_t sourceId;
+
+    /*!
+     * \brief Sequence number given to the next captured frame.
+     */
+    uint64_t nextSequenceId = 0;
+
+    /*!
+     * \brief Whether frames are paced at the frame rate of the video.
+     */
+    bool realtime = true;
 };
 
 #endif // VIDEOPROCESSOR_H